@@ -25,6 +25,8 @@
 namespace gams {
 namespace studio {
 
+static const int CFlushInterval = 20;   // the minimal time (in ms) between two batches of output data
+
 AbstractProcess::AbstractProcess(const QString &appName, QObject *parent)
     : QObject (parent),
       mProcess(this),
@@ -104,6 +106,9 @@ AbstractSingleProcess::AbstractSingleProcess(const QString &application, QObject
     connect(&mProcess, &QProcess::readyReadStandardOutput, this, &AbstractSingleProcess::readStdOut);
     connect(&mProcess, &QProcess::readyReadStandardError, this, &AbstractSingleProcess::readStdErr);
     connect(&mProcess, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(completed(int)));
+    mFlushTimer.setSingleShot(true);
+    mFlushTimer.setInterval(CFlushInterval);
+    connect(&mFlushTimer, &QTimer::timeout, this, &AbstractSingleProcess::flushStdChannelData);
 }
 
 QProcess::ProcessState AbstractSingleProcess::state() const
@@ -113,6 +118,15 @@ QProcess::ProcessState AbstractSingleProcess::state() const
 
 void AbstractSingleProcess::readStdChannel(QProcess::ProcessChannel channel)
 {
+    if (mBatchedOutput) {
+        // drain the channel at once and emit the collected data with the next flush
+        QMutexLocker locker(&mOutputMutex);
+        mProcess.setReadChannel(channel);
+        mPendingOutput.append(mProcess.readAll());
+        if (!mPendingOutput.isEmpty() && !mFlushTimer.isActive())
+            mFlushTimer.start();
+        return;
+    }
     mOutputMutex.lock();
     mProcess.setReadChannel(channel);
     bool avail = mProcess.bytesAvailable();
@@ -127,6 +141,31 @@ void AbstractSingleProcess::readStdChannel(QProcess::ProcessChannel channel)
     }
 }
 
+void AbstractSingleProcess::setBatchedOutput(bool batched)
+{
+    if (!batched) flushStdChannelData();
+    mBatchedOutput = batched;
+}
+
+void AbstractSingleProcess::flushStdChannelData()
+{
+    mFlushTimer.stop();
+    if (mPendingOutput.isEmpty()) return;
+    QByteArray data;
+    data.swap(mPendingOutput);
+    emit newStdChannelData(data);
+}
+
+void AbstractSingleProcess::completed(int exitCode)
+{
+    if (mBatchedOutput) {
+        readStdChannel(QProcess::StandardOutput);
+        readStdChannel(QProcess::StandardError);
+        flushStdChannelData();
+    }
+    AbstractProcess::completed(exitCode);
+}
+
 void AbstractSingleProcess::readStdOut()
 {
     readStdChannel(QProcess::StandardOutput);
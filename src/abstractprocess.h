@@ -23,6 +23,7 @@
 #include <QObject>
 #include <QProcess>
 #include <QMutex>
+#include <QTimer>
 
 #include "common.h"
 
@@ -107,10 +108,20 @@ public:
 
 protected:
     void readStdChannel(QProcess::ProcessChannel channel);
+    void setBatchedOutput(bool batched);
 
 protected slots:
+    void completed(int exitCode) override;
     void readStdOut() override;
     void readStdErr() override;
+
+private slots:
+    void flushStdChannelData();
+
+private:
+    bool mBatchedOutput = false;    // emit whole buffers at a bounded rate instead of single lines
+    QByteArray mPendingOutput;
+    QTimer mFlushTimer;
 };
 
 class AbstractGamsProcess : public AbstractSingleProcess
@@ -131,7 +131,7 @@ operator<<(QTextStream &dbg, T enumValue)
     return dbg << mo->enumerator(enumIdx).valueToKey(int(enumValue));
 }
 
-const int MAX_SEARCH_RESULTS = 50000;
+const int MAX_SEARCH_RESULTS = 2000000;
 const double TABLE_ROW_HEIGHT = 1.6;
 
 const int GAMSRETRN_TOO_MANY_SCRATCH_DIRS = 110;
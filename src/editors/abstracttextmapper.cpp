@@ -28,8 +28,11 @@
 namespace gams {
 namespace studio {
 
+static const int CDecodedChunks = 4;  // the count of chunks kept decoded
+
 AbstractTextMapper::AbstractTextMapper(QObject *parent): QObject(parent)
 {
+    mDecodedChunks.resize(CDecodedChunks);
     mCodec = QTextCodec::codecForLocale();
     setMappingSizes();
     setPosAbsolute(nullptr, 0, 0);
@@ -46,6 +49,7 @@ QTextCodec *AbstractTextMapper::codec() const
 void AbstractTextMapper::setCodec(QTextCodec *codec)
 {
     mCodec = codec;
+    invalidateDecodedChunks();
 }
 
 bool AbstractTextMapper::isEmpty() const
@@ -106,6 +110,7 @@ void AbstractTextMapper::reset()
     mBytesPerLine = 20.0;
     mChunkMetrics.squeeze();
     mDelimiter.clear();
+    invalidateDecodedChunks();
 }
 
 qint64 AbstractTextMapper::size() const
@@ -117,6 +122,7 @@ void AbstractTextMapper::invalidateLineOffsets(Chunk *chunk, bool cutRemain) con
 {
     // TODO(JM) only called from MemoryMapper -> may be moved there OR joined with updateLineOffsets(..)
     if (!chunk) return;
+    invalidateDecodedChunks(chunk->nr);
     ChunkMetrics *cm = chunkMetrics(chunk->nr);
     cm->lineCount = chunk->lineCount();
     cm->linesStartPos = chunk->bStart + chunk->lineBytes.first();
@@ -174,6 +180,42 @@ void AbstractTextMapper::updateLineOffsets(Chunk *chunk) const
     }
 }
 
+void AbstractTextMapper::updateLineNrs() const
+{
+    // extends the line numbers over all consecutive chunks with known metrics (prefix sum)
+    int last = mLastChunkWithLineNr;
+    if (last < 0) {
+        ChunkMetrics *cm = chunkMetrics(0);
+        if (!cm || !cm->isKnown()) return;
+        cm->startLineNr = 0;
+        last = 0;
+    }
+    ChunkMetrics *prevCm = chunkMetrics(last);
+    while (last < chunkCount()-1) {
+        ChunkMetrics *cm = chunkMetrics(last+1);
+        if (!cm->isKnown()) break;
+        cm->startLineNr = prevCm->startLineNr + prevCm->lineCount;
+        prevCm = cm;
+        ++last;
+    }
+    if (last > mLastChunkWithLineNr) {
+        mLastChunkWithLineNr = last;
+        updateBytesPerLine(*prevCm);
+    }
+}
+
+void AbstractTextMapper::invalidateChunkMetrics(int fromChunk) const
+{
+    // forgets the metrics of the chunk and all following chunks, e.g. when the data has grown
+    for (int i = mChunkMetrics.size(); i < chunkCount(); ++i)
+        mChunkMetrics << ChunkMetrics(i);
+    for (int i = qMax(0, fromChunk); i < mChunkMetrics.size(); ++i)
+        mChunkMetrics[i] = ChunkMetrics(i);
+    if (mLastChunkWithLineNr >= fromChunk)
+        mLastChunkWithLineNr = fromChunk - 1;
+    invalidateDecodedChunks();
+}
+
 bool AbstractTextMapper::setMappingSizes(int visibleLines, int chunkSizeInBytes, int chunkOverlap)
 {
     // check constraints
@@ -390,12 +432,11 @@ QString AbstractTextMapper::lines(int localLineNrFrom, int lineCount) const
         Chunk *chunk = chunkForRelativeLine(interval.first, &chunkInterval.first);
         if (!chunk) break;
         chunkInterval.second = qMin(interval.second, chunk->lineCount() - chunkInterval.first);
-        QByteArray raw;
-        raw.setRawData(static_cast<const char*>(chunk->bArray)+chunk->lineBytes.at(chunkInterval.first),
-                       uint(chunk->lineBytes.at(chunkInterval.first+chunkInterval.second)
-                            - chunk->lineBytes.at(chunkInterval.first) - mDelimiter.size()));
+        const DecodedChunk &dc = decodedChunk(chunk);
+        int from = dc.lineStarts.at(chunkInterval.first);
+        int to = dc.lineStarts.at(chunkInterval.first + chunkInterval.second) - mDelimiter.size();
         if (!res.isEmpty()) res.append(mDelimiter);
-        res.append(mCodec ? mCodec->toUnicode(raw) : QString(raw));
+        res.append(dc.text.midRef(from, to - from));
         interval.first += chunkInterval.second;
         interval.second -= chunkInterval.second;
         if (chunk->nr == chunkCount()-1) {
@@ -552,10 +593,60 @@ void AbstractTextMapper::copyToClipboard()
 
 QString AbstractTextMapper::line(AbstractTextMapper::Chunk *chunk, int chunkLineNr) const
 {
-    QByteArray raw;
-    raw.setRawData(static_cast<const char*>(chunk->bArray)+chunk->lineBytes.at(chunkLineNr),
-                   uint(chunk->lineBytes.at(chunkLineNr+1) - chunk->lineBytes.at(chunkLineNr) - mDelimiter.size()));
-    return mCodec ? mCodec->toUnicode(raw) : QString(raw);
+    const DecodedChunk &dc = decodedChunk(chunk);
+    int from = dc.lineStarts.at(chunkLineNr);
+    return dc.text.mid(from, dc.lineStarts.at(chunkLineNr+1) - from - mDelimiter.size());
+}
+
+const AbstractTextMapper::DecodedChunk &AbstractTextMapper::decodedChunk(Chunk *chunk) const
+{
+    int byteSize = chunk->lineBytes.last() - chunk->lineBytes.first();
+    DecodedChunk *dc = &mDecodedChunks[0];
+    for (DecodedChunk &entry : mDecodedChunks) {
+        if (entry.chunkNr == chunk->nr) {
+            dc = &entry;
+            break;
+        }
+        if (entry.lastUse < dc->lastUse) dc = &entry;
+    }
+    dc->lastUse = ++mDecodedUse;
+    int first = 0;
+    if (dc->chunkNr == chunk->nr && dc->bStart == chunk->bStart) {
+        if (dc->byteSize == byteSize && dc->lineStarts.size() == chunk->lineBytes.size())
+            return *dc;
+        // appending to the open tail chunk only changes its last line, the lines before are kept
+        int lastLine = dc->lineStarts.size() - 2;
+        if (lastLine >= 0 && lastLine < chunk->lineCount() && chunk->lineBytes.at(lastLine) == dc->lastLineByte)
+            first = lastLine;
+    }
+
+    // decode line by line into the buffers of the least recently used entry
+    dc->chunkNr = chunk->nr;
+    dc->bStart = chunk->bStart;
+    dc->byteSize = byteSize;
+    dc->text.resize(first ? dc->lineStarts.at(first) : 0);
+    dc->lineStarts.resize(first);
+    dc->lineStarts.reserve(chunk->lineBytes.size());
+    dc->lastLineByte = chunk->lineBytes.at(qMax(0, chunk->lineCount() - 1));
+    QString delimiter = mDelimiter;
+    const char *data = chunk->bArray.constData();
+    for (int i = first; i < chunk->lineCount(); ++i) {
+        int from = chunk->lineBytes.at(i);
+        int len = chunk->lineBytes.at(i+1) - from - mDelimiter.size();
+        dc->lineStarts << dc->text.length();
+        dc->text.append(mCodec ? mCodec->toUnicode(data + from, len) : QString::fromUtf8(data + from, len));
+        dc->text.append(delimiter);
+    }
+    dc->lineStarts << dc->text.length();
+    return *dc;
+}
+
+void AbstractTextMapper::invalidateDecodedChunks(int chunkNr) const
+{
+    for (DecodedChunk &entry : mDecodedChunks) {
+        if (chunkNr < 0 || entry.chunkNr == chunkNr)
+            entry.chunkNr = -1;
+    }
 }
 
 int AbstractTextMapper::lastChunkWithLineNr() const
@@ -696,6 +787,7 @@ void AbstractTextMapper::removeChunk(int chunkNr)
         --cl.chunkNr;
     }
     mChunkMetrics.removeAt(chunkNr);
+    invalidateDecodedChunks();
 
     // shift position, anchor and topline if necessary
     QVector<CursorPosition*> cps;
@@ -94,6 +94,19 @@ private:
         int lineLen = -1;
     };
 
+    /// class DecodedChunk
+    /// Caches the decoded lines of a chunk. The entries and their buffers are reused for other chunks
+    ///
+    struct DecodedChunk {
+        int chunkNr = -1;
+        qint64 bStart = -1;
+        int byteSize = 0;
+        int lastLineByte = -1;      // the start of the last line in the chunk, only this line may grow
+        int lastUse = 0;
+        QString text;               // the decoded lines including the delimiters
+        QVector<int> lineStarts;    // the start of each line in text, the last entry is the end of text
+    };
+
 protected:
     /// class ChunkMetrics
     /// Stores necessary size and line count of a chunk to avoid reloading the chunk
@@ -120,11 +133,12 @@ protected:
         qint64 bStart = -1;
         QByteArray bArray;
         QVector<int> lineBytes;
+        int packedLines = -1;       // the line count while lineBytes only keeps its first and last entry
         int size() {
             return lineBytes.size() > 1 ? lineBytes.last() - lineBytes.first() : 0;
         }
         bool isValid() const { return bStart >= 0;}
-        int lineCount() const { return lineBytes.size()-1; }
+        int lineCount() const { return packedLines >= 0 ? packedLines : lineBytes.size()-1; }
     };
 
 public:
@@ -196,6 +210,9 @@ protected:
     qint64 lastTopAbsPos();
     void invalidateLineOffsets(Chunk *chunk, bool cutRemain = false) const;
     void updateLineOffsets(Chunk *chunk) const;
+    void updateLineNrs() const;
+    void invalidateChunkMetrics(int fromChunk) const;
+    void invalidateDecodedChunks(int chunkNr = -1) const;
     int chunkSize() const;
     int maxLineWidth() const;
     void initChunkCount(int count) const;
@@ -210,6 +227,7 @@ protected:
 private:
     QString lines(Chunk *chunk, int startLine, int &lineCount) const;
     QString line(Chunk *chunk, int chunkLineNr) const;
+    const DecodedChunk &decodedChunk(Chunk *chunk) const;
     bool setTopLine(const Chunk *chunk, int localLine);
     void updateBytesPerLine(const ChunkMetrics &chunkMetrics) const;
     int maxChunksInCache() const;
@@ -223,6 +241,8 @@ private:
     mutable QVector<ChunkMetrics> mChunkMetrics;
     mutable int mLastChunkWithLineNr = -1;
     mutable double mBytesPerLine = 20.0;
+    mutable QVector<DecodedChunk> mDecodedChunks;
+    mutable int mDecodedUse = 0;
 
     LinePosition mTopLine;
     LinePosition mMaxTopLine;
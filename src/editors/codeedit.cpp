@@ -33,6 +33,8 @@
 namespace gams {
 namespace studio {
 
+static const int CMaxMatchCacheBlocks = 10000;  // the cache of search matches is reset when it exceeds this size
+
 inline const KeySeqList &hotkey(Hotkey _hotkey) { return Keys::instance().keySequence(_hotkey); }
 
 CodeEdit::CodeEdit(QWidget *parent)
@@ -121,6 +123,10 @@ void CodeEdit::updateLineNumberArea(const QRect &rect, int dy)
 
     if (rect.contains(viewport()->rect()))
         updateLineNumberAreaWidth();
+    if (dy || rect.contains(viewport()->rect())) {
+        QTextBlock lastBlock = cursorForPosition(QPoint(0, viewport()->height())).block();
+        emit visibleBlocksChanged(firstVisibleBlock().blockNumber(), lastBlock.blockNumber());
+    }
 }
 
 void CodeEdit::blockEditBlink()
@@ -1326,24 +1332,23 @@ void CodeEdit::extraSelMatches(QList<QTextEdit::ExtraSelection> &selections)
     search::SearchResultList* list = searchDialog->results();
     if (!list) return;
 
-    if (list->filteredResultList(ViewHelper::location(this)).isEmpty()) return;
+    if (list->fileRows(ViewHelper::location(this)).isEmpty()) return;
 
     QRegularExpression regEx = list->searchRegex();
+    QColor matchesBg = mSettings->colorScheme().value("Edit.matchesBg", QColor(Qt::green).lighter(160));
 
     QTextBlock block = firstVisibleBlock();
     int top = qRound(blockBoundingGeometry(block).translated(contentOffset()).top());
     while (block.isValid() && top < viewport()->height()) {
         top += qRound(blockBoundingRect(block).height());
 
-        QRegularExpressionMatchIterator i = regEx.globalMatch(block.text());
-        while (i.hasNext()) {
-            QRegularExpressionMatch m = i.next();
+        for (const QPair<int, int> &match : blockMatches(block, regEx)) {
             QTextEdit::ExtraSelection selection;
             QTextCursor tc(document());
-            tc.setPosition(block.position() + m.capturedStart(0));
-            tc.movePosition(QTextCursor::Right, QTextCursor::KeepAnchor, m.capturedLength(0));
+            tc.setPosition(block.position() + match.first);
+            tc.setPosition(block.position() + match.first + match.second, QTextCursor::KeepAnchor);
             selection.cursor = tc;
-            selection.format.setBackground(mSettings->colorScheme().value("Edit.matchesBg", QColor(Qt::green).lighter(160)));
+            selection.format.setBackground(matchesBg);
             selections << selection;
         }
 
@@ -1351,6 +1356,30 @@ void CodeEdit::extraSelMatches(QList<QTextEdit::ExtraSelection> &selections)
     }
 }
 
+const QVector<QPair<int, int>> &CodeEdit::blockMatches(const QTextBlock &block, const QRegularExpression &regex)
+{
+    // the cache is dropped when the search or the line structure changed, edited blocks get a new revision
+    if (regex != mMatchRegex || document() != mMatchDocument || blockCount() != mMatchBlockCount
+            || mMatchCache.size() > CMaxMatchCacheBlocks) {
+        mMatchCache.clear();
+        mMatchRegex = regex;
+        mMatchDocument = document();
+        mMatchBlockCount = blockCount();
+    }
+    BlockMatches &entry = mMatchCache[block.blockNumber()];
+    if (entry.revision != block.revision() || entry.length != block.length()) {
+        entry.revision = block.revision();
+        entry.length = block.length();
+        entry.matches.clear();
+        QRegularExpressionMatchIterator i = regex.globalMatch(block.text());
+        while (i.hasNext()) {
+            QRegularExpressionMatch m = i.next();
+            entry.matches << qMakePair(m.capturedStart(0), m.capturedLength(0));
+        }
+    }
+    return entry.matches;
+}
+
 QPoint CodeEdit::toolTipPos(const QPoint &mousePos)
 {
     QPoint pos = AbstractEdit::toolTipPos(mousePos);
@@ -23,6 +23,7 @@
 #include <QTextBlockUserData>
 #include <QHash>
 #include <QIcon>
+#include <QRegularExpression>
 #include <QTimer>
 #include "editors/abstractedit.h"
 #include "syntax/textmark.h"
@@ -156,6 +157,7 @@ signals:
     void requestMarkHash(QHash<int, TextMark*>* marks, TextMark::Type filter);
     void requestMarksEmpty(bool* marksEmpty);
     void requestSyntaxKind(int position, int &intKind);
+    void visibleBlocksChanged(int firstBlockNr, int lastBlockNr);
     void searchFindNextPressed();
     void searchFindPrevPressed();
     void requestAdvancedActions(QList<QAction*>* actions);
@@ -248,6 +250,13 @@ protected:
     BlockEdit* blockEdit() {return mBlockEdit;}
 
 private:
+    struct BlockMatches {
+        int revision = -1;
+        int length = 0;
+        QVector<QPair<int, int>> matches;   // start and length of each match in the block
+    };
+    const QVector<QPair<int, int>> &blockMatches(const QTextBlock &block, const QRegularExpression &regex);
+
     LineNumberArea *mLineNumberArea;
     int mCurrentCol;
     QTimer mCursorTimer;
@@ -269,6 +278,10 @@ private:
     const QString mClosing = ")]}'\"";
     bool mAllowBlockEdit = true;
     int mLnAreaWidth = 0;
+    QHash<int, BlockMatches> mMatchCache;   // the search matches of the blocks that have been visible
+    QRegularExpression mMatchRegex;
+    const QTextDocument *mMatchDocument = nullptr;
+    int mMatchBlockCount = 0;
 };
 
 class LineNumberArea : public QWidget
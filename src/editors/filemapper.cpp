@@ -18,17 +18,31 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "filemapper.h"
+#include "linescanner.h"
 #include "exception.h"
 #include "logger.h"
 #include <QFile>
 #include <QTextStream>
 #include <QGuiApplication>
 #include <QClipboard>
+#include <QtConcurrent>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
 
 namespace gams {
 namespace studio {
 
-static const int CMaxChunksInCache = 5;
+static const int CMaxChunksInCache = 5;                 // with a mapping the cached chunks keep only their line index
+static const int CChunksPerIndexJob = 16;
+static const qint64 CLineIndexMinSize = 32*1024*1024;   // smaller files are indexed fast enough
+static const int CFingerprintSize = 4096;
+static const quint32 CLineIndexMagic = 0x47534c49;      // "GSLI"
+static const quint32 CLineIndexVersion = 1;
 
 FileMapper::FileMapper(QObject *parent): AbstractTextMapper(parent)
 {
@@ -37,11 +51,15 @@ FileMapper::FileMapper(QObject *parent): AbstractTextMapper(parent)
     connect(&mTimer, &QTimer::timeout, this, &FileMapper::closeFile);
     mPeekTimer.setSingleShot(true);
     connect(&mPeekTimer, &QTimer::timeout, this, &FileMapper::peekChunksForLineNrs);
+    connect(&mIndexWatcher, &QFutureWatcher<QVector<ChunkMetrics>>::resultReadyAt,
+            this, &FileMapper::indexResultReady);
+    connect(&mIndexWatcher, &QFutureWatcher<QVector<ChunkMetrics>>::finished, this, &FileMapper::indexFinished);
     closeAndReset();
 }
 
 FileMapper::~FileMapper()
 {
+    stopIndexing();
     closeFile();
 }
 
@@ -56,20 +74,62 @@ bool FileMapper::openFile(const QString &fileName, bool initAnchor)
             return false;
         }
         mSize = mFile.size();
-        int chunkCount = int(mFile.size()/chunkSize())+1;
-        initChunkCount(chunkCount);
+        mapFile();
+        mHeadHash = fingerprint(0, CFingerprintSize);
+        mTailHash = fingerprint(mSize - CFingerprintSize, CFingerprintSize);
+        initChunkCount(chunkCount());
         Chunk *chunk = getChunk(0);
         if (chunk && chunk->isValid()) {
+            int knownChunks = loadLineIndex();
             emitBlockCountChanged();
             if (initAnchor) initTopLine();
             updateMaxTop();
-            mPeekTimer.start(100);
+            if (knownChunks == chunkCount()) {
+                emit loadAmountChanged(knownLineNrs());
+            } else if (!startIndexing(knownChunks)) {
+                mPeekTimer.start(100);
+            }
             return true;
         }
     }
     return false;
 }
 
+bool FileMapper::followGrowth()
+{
+    // only appended data is indexed, otherwise the file needs to be reloaded
+    if (!size() || mHeadHash.isEmpty()) return false;
+    qint64 newSize = QFileInfo(mFile.fileName()).size();
+    if (newSize <= size()) return false;
+    if (fingerprint(0, CFingerprintSize) != mHeadHash
+            || fingerprint(size() - CFingerprintSize, CFingerprintSize) != mTailHash)
+        return false;
+
+    stopIndexing();
+    mPeekTimer.stop();
+    // the former last chunk (or one ending exactly at the former end) gets new content
+    int firstChanged = int((size() - 1) / chunkSize());
+    if (mMapped) {
+        QMutexLocker locker(&mMutex);
+        unmapFile();
+    } else {
+        for (int i = mChunkCache.size()-1; i >= 0; --i) {
+            if (mChunkCache.at(i)->nr >= firstChanged)
+                chunkUncached(mChunkCache.takeAt(i));
+        }
+    }
+    mSize = newSize;
+    mapFile();
+    mTailHash = fingerprint(mSize - CFingerprintSize, CFingerprintSize);
+    invalidateChunkMetrics(firstChanged);
+    updateMaxTop(); // keeps the view at the tail if it has been there
+
+    if (!startIndexing(firstChanged)) mPeekTimer.start(50);
+    emitBlockCountChanged();
+    emit loadAmountChanged(knownLineNrs());
+    return true;
+}
+
 bool FileMapper::reload()
 {
     QString fileName = mFile.fileName();
@@ -81,6 +141,7 @@ bool FileMapper::reload()
 
 void FileMapper::closeAndReset()
 {
+    stopIndexing();
     while (mChunkCache.size()) {
         chunkUncached(mChunkCache.takeFirst());
     }
@@ -88,6 +149,9 @@ void FileMapper::closeAndReset()
     mFile.setFileName(mFile.fileName()); // JM: Workaround for file kept locked (close wasn't enough)
 
     mSize = 0;
+    mMappingEnabled = true;
+    mHeadHash.clear();
+    mTailHash.clear();
     AbstractTextMapper::reset();
     setPosAbsolute(nullptr, 0, 0);
     stopPeeking();
@@ -111,7 +175,11 @@ FileMapper::Chunk* FileMapper::getChunk(int chunkNr, bool cache) const
 
     int bSize = 0;
     QByteArray bArray;
-    if (!mFile.isOpen() && !mFile.open(QFile::ReadOnly)) {
+    if (mMapped || mapFile()) {
+        // zero-copy: the chunk is a view into the mapped file
+        bSize = int(cEnd - cStart);
+        bArray = QByteArray::fromRawData(reinterpret_cast<const char*>(mMapped + cStart), bSize);
+    } else if (!mFile.isOpen() && !mFile.open(QFile::ReadOnly)) {
         DEB() << "Could not open file " << mFile.fileName();
         return nullptr;
     } else {
@@ -133,19 +201,20 @@ FileMapper::Chunk* FileMapper::getChunk(int chunkNr, bool cache) const
 
     // create index for linebreaks
     if (!delimiter().isEmpty()) {
-        int lines = res->bArray.count(delimiter().at(0));
-        res->lineBytes.reserve(lines+2);
+        const char delim = delimiter().at(0);
+        const int delimSize = delimiter().size();
+        // a delimiter before headEnd starts a line at or before chunkStart
+        int headEnd = qBound(0, int(chunkStart - cStart) + 1 - delimSize, bSize);
         res->lineBytes << 0;
-        for (int i = 0; i < bSize; ++i) {
-            if (res->bArray.at(i) == delimiter().at(0)) {
-                if (res->bStart+i+delimiter().size() <= chunkStart) {
-                    // first [lf] before chunkStart
-                    res->lineBytes[0] = (i + delimiter().size());
-                } else {
-                    res->lineBytes << (i + delimiter().size());
-                }
+        for (int i = headEnd-1; i >= 0; --i) {
+            if (res->bArray.at(i) == delim) {
+                // last [lf] before chunkStart
+                res->lineBytes[0] = i + delimSize;
+                break;
             }
         }
+        LineScanner::lineStarts(res->bArray.constData() + headEnd, bSize - headEnd, delim, headEnd + delimSize,
+                                res->lineBytes);
     }
     if (cEnd == size())
         res->lineBytes << (bSize + delimiter().size());
@@ -162,11 +231,49 @@ FileMapper::Chunk* FileMapper::getChunk(int chunkNr, bool cache) const
 void FileMapper::chunkUncached(AbstractTextMapper::Chunk *chunk) const
 {
     if (!chunk) return;
-    chunk->bArray.resize(0);
-    chunk->bArray.squeeze();
+    invalidateDecodedChunks(chunk->nr);
+    if (!mMapped) {
+        chunk->bArray.resize(0);
+        chunk->bArray.squeeze();
+    }
     delete chunk;
 }
 
+bool FileMapper::mapFile() const
+{
+    if (mMapped) return true;
+    if (!mMappingEnabled || !mSize) return false;
+    QMutexLocker locker(&mMutex);
+    if (!mFile.isOpen() && !mFile.open(QFile::ReadOnly)) return false;
+    // touching pages beyond the end of a truncated file fails (SIGBUS on POSIX), so a shrunken file is read instead
+    if (mFile.size() < mSize) {
+        DEB() << "File " << mFile.fileName() << " has been truncated, reading chunks instead";
+        mMappingEnabled = false;
+        return false;
+    }
+    mMapped = mFile.map(0, mSize);
+    if (!mMapped) {
+        // e.g. address space exhausted: fall back to reading the chunks
+        DEB() << "Could not map file " << mFile.fileName() << ", reading chunks instead";
+        mMappingEnabled = false;
+        return false;
+    }
+    // like the file handle, the mapping is released by closeFile() when the file hasn't been accessed for a while
+    mTimer.start();
+    return true;
+}
+
+void FileMapper::unmapFile() const
+{
+    if (!mMapped) return;
+    // the cached chunks are views into the mapping and must not survive it
+    while (mChunkCache.size()) {
+        chunkUncached(mChunkCache.takeFirst());
+    }
+    mFile.unmap(mMapped);
+    mMapped = nullptr;
+}
+
 void FileMapper::startRun()
 {
     closeAndReset();
@@ -179,8 +286,14 @@ void FileMapper::endRun()
 
 void FileMapper::closeFile()
 {
+    // the index workers may read the mapped file, the handle is released after they finished
+    if (mIndexWatcher.isRunning()) {
+        mTimer.start();
+        return;
+    }
     QMutexLocker locker(&mMutex);
     mTimer.stop();
+    unmapFile();
     if (mFile.isOpen()) {
         mFile.close();
     }
@@ -244,6 +357,231 @@ void FileMapper::reset()
     closeAndReset();
 }
 
+bool FileMapper::startIndexing(int fromChunk)
+{
+    if (delimiter().isEmpty() || chunkCount() < 2) return false;
+    IndexJob job;
+    job.fileName = mFile.fileName();
+    job.mapped = mMapped;
+    job.size = size();
+    job.chunkSize = chunkSize();
+    job.maxLineWidth = maxLineWidth();
+    job.delimiter = delimiter();
+    QVector<IndexJob> jobs;
+    jobs.reserve((chunkCount() - fromChunk) / CChunksPerIndexJob + 1);
+    for (int i = fromChunk; i < chunkCount(); i += CChunksPerIndexJob) {
+        job.firstChunk = i;
+        job.lastChunk = qMin(i + CChunksPerIndexJob, chunkCount()) - 1;
+        jobs << job;
+    }
+    mIndexWatcher.setFuture(QtConcurrent::mapped(jobs, &FileMapper::indexChunks));
+    return true;
+}
+
+void FileMapper::stopIndexing()
+{
+    // the workers may read the mapped file, so wait until they stopped
+    if (mIndexWatcher.isRunning()) {
+        mIndexWatcher.cancel();
+        mIndexWatcher.waitForFinished();
+    }
+}
+
+QVector<AbstractTextMapper::ChunkMetrics> FileMapper::indexChunks(const FileMapper::IndexJob &job)
+{
+    // counts the lines the same way getChunk() does to get equal ChunkMetrics
+    QVector<ChunkMetrics> res;
+    res.reserve(job.lastChunk - job.firstChunk + 1);
+    QFile file;
+    QByteArray buffer;
+    if (!job.mapped) {
+        file.setFileName(job.fileName);
+        if (!file.open(QFile::ReadOnly)) return res;
+        buffer.resize(job.chunkSize + job.maxLineWidth);
+    }
+    const char delim = job.delimiter.at(0);
+    const int delimSize = job.delimiter.size();
+    for (int nr = job.firstChunk; nr <= job.lastChunk; ++nr) {
+        qint64 chunkStart = qint64(nr) * job.chunkSize;
+        if (chunkStart >= job.size) break;
+        qint64 cStart = qMax(0LL, chunkStart - job.maxLineWidth);
+        qint64 cEnd = qMin(job.size, chunkStart + job.chunkSize);
+        int bSize = int(cEnd - cStart);
+        const char *data = nullptr;
+        if (job.mapped) {
+            data = reinterpret_cast<const char*>(job.mapped + cStart);
+        } else {
+            if (!file.seek(cStart)) break;
+            bSize = int(file.read(buffer.data(), bSize));
+            if (bSize < 0) break;
+            data = buffer.constData();
+        }
+        int firstLine = 0;
+        int lastLine = 0;
+        int headEnd = qBound(0, int(chunkStart - cStart) + 1 - delimSize, bSize);
+        for (int i = headEnd-1; i >= 0; --i) {
+            if (data[i] == delim) {
+                firstLine = i + delimSize;
+                break;
+            }
+        }
+        int lines = LineScanner::count(data + headEnd, bSize - headEnd, delim);
+        if (lines) {
+            int i = bSize-1;
+            while (data[i] != delim) --i;
+            lastLine = i + delimSize;
+        }
+        if (cEnd == job.size) {
+            lastLine = bSize + delimSize;
+            ++lines;
+        }
+        ChunkMetrics cm(nr, lines);
+        cm.linesStartPos = cStart + firstLine;
+        cm.linesByteSize = lines ? lastLine - firstLine : 0;
+        res << cm;
+    }
+    return res;
+}
+
+void FileMapper::indexResultReady(int index)
+{
+    const QVector<ChunkMetrics> metrics = mIndexWatcher.resultAt(index);
+    for (const ChunkMetrics &indexed: metrics) {
+        ChunkMetrics *cm = chunkMetrics(indexed.chunkNr);
+        if (!cm || cm->isKnown()) continue;
+        cm->lineCount = indexed.lineCount;
+        cm->linesStartPos = indexed.linesStartPos;
+        cm->linesByteSize = indexed.linesByteSize;
+    }
+    int known = lastChunkWithLineNr();
+    updateLineNrs();
+    if (known != lastChunkWithLineNr())
+        emit loadAmountChanged(knownLineNrs());
+}
+
+void FileMapper::indexFinished()
+{
+    if (mIndexWatcher.isCanceled()) return;
+    // missing chunks (e.g. on read errors) are still peeked on the GUI thread
+    if (lastChunkWithLineNr() < chunkCount()-1)
+        mPeekTimer.start(50);
+    else
+        saveLineIndex();
+    emit loadAmountChanged(knownLineNrs());
+    emitBlockCountChanged();
+    emit selectionChanged();
+}
+
+QString FileMapper::lineIndexFileName() const
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty()) return QString();
+    QByteArray key = QCryptographicHash::hash(QFileInfo(mFile).absoluteFilePath().toUtf8(),
+                                              QCryptographicHash::Sha1).toHex();
+    return QDir::cleanPath(dir + "/lineindex/" + key + ".idx");
+}
+
+QByteArray FileMapper::fingerprint(qint64 start, int len) const
+{
+    start = qMax(0LL, start);
+    len = int(qMin(qint64(len), size() - start));
+    if (len <= 0) return QByteArray();
+    QByteArray data;
+    if (mMapped) {
+        data = QByteArray::fromRawData(reinterpret_cast<const char*>(mMapped + start), len);
+        mTimer.start();
+    } else {
+        QMutexLocker locker(&mMutex);
+        if (!mFile.isOpen() && !mFile.open(QFile::ReadOnly)) return QByteArray();
+        mFile.seek(start);
+        data = mFile.read(len);
+        mTimer.start();
+    }
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+int FileMapper::loadLineIndex()
+{
+    // returns the count of leading chunks with restored metrics
+    if (size() < CLineIndexMinSize) return 0;
+    QFile idxFile(lineIndexFileName());
+    if (idxFile.fileName().isEmpty() || !idxFile.open(QFile::ReadOnly)) return 0;
+    QDataStream in(&idxFile);
+    quint32 magic;
+    quint32 version;
+    qint32 storedChunkSize;
+    qint32 storedLineWidth;
+    QByteArray storedDelimiter;
+    qint64 storedSize;
+    qint64 storedModified;
+    QByteArray headHash;
+    QByteArray tailHash;
+    qint32 count;
+    in >> magic >> version;
+    if (magic != CLineIndexMagic || version != CLineIndexVersion) return 0;
+    in >> storedChunkSize >> storedLineWidth >> storedDelimiter >> storedSize >> storedModified
+       >> headHash >> tailHash >> count;
+    if (in.status() != QDataStream::Ok || storedChunkSize != chunkSize() || storedLineWidth != maxLineWidth()
+            || storedDelimiter != delimiter() || storedSize > size() || count < 0 || count > chunkCount())
+        return 0;
+
+    int validChunks = count;
+    if (storedSize == size()) {
+        // rewritten with the same size
+        if (QFileInfo(mFile).lastModified().toMSecsSinceEpoch() != storedModified) return 0;
+    } else {
+        // the file has grown: the last chunk (and any chunk ending at the old end) has to be indexed again
+        validChunks = int(qMin(qint64(count), (storedSize - 1) / chunkSize()));
+    }
+    if (mHeadHash != headHash || (storedSize == size() ? mTailHash
+            : fingerprint(storedSize - CFingerprintSize, CFingerprintSize)) != tailHash)
+        return 0;
+
+    QVector<ChunkMetrics> metrics;
+    metrics.reserve(validChunks);
+    for (int i = 0; i < validChunks; ++i) {
+        qint32 lineCount;
+        qint64 linesStartPos;
+        qint32 linesByteSize;
+        in >> lineCount >> linesStartPos >> linesByteSize;
+        ChunkMetrics cm(i, lineCount);
+        cm.linesStartPos = linesStartPos;
+        cm.linesByteSize = linesByteSize;
+        metrics << cm;
+    }
+    if (in.status() != QDataStream::Ok) return 0;
+    for (const ChunkMetrics &stored: metrics) {
+        ChunkMetrics *cm = chunkMetrics(stored.chunkNr);
+        if (cm->isKnown()) continue;
+        cm->lineCount = stored.lineCount;
+        cm->linesStartPos = stored.linesStartPos;
+        cm->linesByteSize = stored.linesByteSize;
+    }
+    updateLineNrs();
+    return validChunks;
+}
+
+void FileMapper::saveLineIndex() const
+{
+    if (size() < CLineIndexMinSize || lastChunkWithLineNr() < chunkCount()-1) return;
+    QString fileName = lineIndexFileName();
+    if (fileName.isEmpty() || !QDir().mkpath(QFileInfo(fileName).path())) return;
+    QSaveFile idxFile(fileName);
+    if (!idxFile.open(QFile::WriteOnly)) {
+        DEB() << "Could not write line index " << fileName;
+        return;
+    }
+    QDataStream out(&idxFile);
+    out << CLineIndexMagic << CLineIndexVersion << qint32(chunkSize()) << qint32(maxLineWidth()) << delimiter()
+        << size() << QFileInfo(mFile).lastModified().toMSecsSinceEpoch()
+        << mHeadHash << mTailHash << qint32(chunkCount());
+    for (int i = 0; i < chunkCount(); ++i) {
+        ChunkMetrics *cm = chunkMetrics(i);
+        out << qint32(cm->lineCount) << qint64(cm->linesStartPos) << qint32(cm->linesByteSize);
+    }
+    idxFile.commit();
+}
+
 void FileMapper::stopPeeking()
 {
     mPeekTimer.stop();
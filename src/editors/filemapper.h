@@ -28,6 +28,7 @@
 #include <QTextDocument>
 #include <QMutex>
 #include <QTimer>
+#include <QFutureWatcher>
 #include "abstracttextmapper.h"
 //#include "syntax.h"
 
@@ -37,11 +38,29 @@ namespace studio {
 ///
 /// class FileMapper
 /// Opens a file into (equal sized) chunks of QByteArrays that are loaded on request. Uses indexes to build the lines
-/// for the model on the fly.
+/// for the model on the fly. If possible the whole file is memory-mapped and the chunks are views into the mapping,
+/// otherwise the chunks are read from the file. The line index of large files is kept in a cache directory to
+/// have the line numbers available instantly when the file is opened again. Files that only grow (like logs of
+/// external jobs) can be followed without reloading the known part.
 ///
 class FileMapper: public AbstractTextMapper
 {
     Q_OBJECT
+private:
+    /// class IndexJob
+    /// Describes a range of chunks to be indexed by a worker thread
+    ///
+    struct IndexJob {
+        QString fileName;
+        const uchar *mapped = nullptr;
+        qint64 size = 0;
+        int chunkSize = 0;
+        int maxLineWidth = 0;
+        QByteArray delimiter;
+        int firstChunk = 0;
+        int lastChunk = 0;
+    };
+
 public:
     FileMapper(QObject *parent = nullptr);
     ~FileMapper() override;
@@ -49,10 +68,12 @@ public:
     int chunkCount() const override { return int(qMax(0LL,size()-1)/chunkSize()) + 1; }
 
     bool openFile(const QString &fileName, bool initAnchor);
+    bool followGrowth();
     qint64 size() const override { return mSize; }
     void startRun() override;
     void endRun() override;
     int lineCount() const override;
+    bool isMapped() const { return mMapped != nullptr; }
 
 public slots:
     void peekChunksForLineNrs();
@@ -64,12 +85,23 @@ protected:
 private slots:
     void closeAndReset();
     void closeFile();                                           //2FF
+    void indexResultReady(int index);
+    void indexFinished();
 
 private:
     Chunk *getFromCache(int chunkNr) const;
     void chunkUncached(Chunk *chunk) const;
+    bool mapFile() const;
+    void unmapFile() const;
     bool reload();
     void stopPeeking();
+    bool startIndexing(int fromChunk = 0);
+    void stopIndexing();
+    int loadLineIndex();
+    void saveLineIndex() const;
+    QString lineIndexFileName() const;
+    QByteArray fingerprint(qint64 start, int len) const;
+    static QVector<ChunkMetrics> indexChunks(const IndexJob &job);
 
 private:
     mutable QFile mFile;                // mutable to provide consistant logical const-correctness
@@ -77,9 +109,14 @@ private:
     mutable QMutex mMutex;
     mutable QTimer mTimer;
 
+    mutable uchar *mMapped = nullptr;  // the whole file if memory-mapping succeeded
+    mutable bool mMappingEnabled = true;    // false after mapping failed, until the file is reopened
     qint64 mSize = 0;
+    QByteArray mHeadHash;               // fingerprints to detect if the file only has grown
+    QByteArray mTailHash;
 
     QTimer mPeekTimer;
+    QFutureWatcher<QVector<ChunkMetrics>> mIndexWatcher;
 };
 
 } // namespace studio
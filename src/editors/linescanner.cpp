@@ -0,0 +1,272 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "linescanner.h"
+#include <QAtomicInt>
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define LINESCANNER_X86
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#    define LINESCANNER_AVX2
+#  else
+#    define LINESCANNER_AVX2 __attribute__((target("avx2")))
+#  endif
+#endif
+
+namespace gams {
+namespace studio {
+
+// ----- scalar kernels -----
+
+static int lineStartsScalar(const char *data, int size, char delim, int shift, QVector<int> &lineStarts)
+{
+    int res = 0;
+    const char *pos = data;
+    const char *end = data + size;
+    while ((pos = static_cast<const char*>(memchr(pos, delim, size_t(end - pos))))) {
+        lineStarts << int(pos - data) + shift;
+        ++res;
+        ++pos;
+    }
+    return res;
+}
+
+static int countScalar(const char *data, int size, char delim)
+{
+    int res = 0;
+    const char *pos = data;
+    const char *end = data + size;
+    while ((pos = static_cast<const char*>(memchr(pos, delim, size_t(end - pos))))) {
+        ++res;
+        ++pos;
+    }
+    return res;
+}
+
+static int nextLineBreakScalar(const char *data, int from, int size)
+{
+    for (int i = from; i < size; ++i) {
+        if (data[i] == '\n' || data[i] == '\r') return i;
+    }
+    return -1;
+}
+
+#ifdef LINESCANNER_X86
+
+// ----- SSE2 kernels (always available on x86-64) -----
+
+static int lineStartsSse2(const char *data, int size, char delim, int shift, QVector<int> &lineStarts)
+{
+    int res = 0;
+    int i = 0;
+    const __m128i d = _mm_set1_epi8(delim);
+    for ( ; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        quint32 mask = quint32(_mm_movemask_epi8(_mm_cmpeq_epi8(v, d)));
+        while (mask) {
+            lineStarts << i + int(qCountTrailingZeroBits(mask)) + shift;
+            ++res;
+            mask &= mask - 1;
+        }
+    }
+    return res + lineStartsScalar(data + i, size - i, delim, shift + i, lineStarts);
+}
+
+static int countSse2(const char *data, int size, char delim)
+{
+    int res = 0;
+    int i = 0;
+    const __m128i d = _mm_set1_epi8(delim);
+    for ( ; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        res += int(qPopulationCount(quint32(_mm_movemask_epi8(_mm_cmpeq_epi8(v, d)))));
+    }
+    return res + countScalar(data + i, size - i, delim);
+}
+
+static int nextLineBreakSse2(const char *data, int from, int size)
+{
+    int i = from;
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    for ( ; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        quint32 mask = quint32(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr))));
+        if (mask) return i + int(qCountTrailingZeroBits(mask));
+    }
+    return nextLineBreakScalar(data, i, size);
+}
+
+// ----- AVX2 kernels (selected at runtime) -----
+
+LINESCANNER_AVX2
+static int lineStartsAvx2(const char *data, int size, char delim, int shift, QVector<int> &lineStarts)
+{
+    int res = 0;
+    int i = 0;
+    const __m256i d = _mm256_set1_epi8(delim);
+    for ( ; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        quint32 mask = quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, d)));
+        while (mask) {
+            lineStarts << i + int(qCountTrailingZeroBits(mask)) + shift;
+            ++res;
+            mask &= mask - 1;
+        }
+    }
+    return res + lineStartsSse2(data + i, size - i, delim, shift + i, lineStarts);
+}
+
+LINESCANNER_AVX2
+static int countAvx2(const char *data, int size, char delim)
+{
+    int res = 0;
+    int i = 0;
+    const __m256i d = _mm256_set1_epi8(delim);
+    for ( ; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        res += int(qPopulationCount(quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, d)))));
+    }
+    return res + countSse2(data + i, size - i, delim);
+}
+
+LINESCANNER_AVX2
+static int nextLineBreakAvx2(const char *data, int from, int size)
+{
+    int i = from;
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    for ( ; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        quint32 mask = quint32(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, lf),
+                                                                    _mm256_cmpeq_epi8(v, cr))));
+        if (mask) return i + int(qCountTrailingZeroBits(mask));
+    }
+    return nextLineBreakSse2(data, i, size);
+}
+
+static bool cpuHasAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false; // OS saves the YMM registers
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // LINESCANNER_X86
+
+// ----- dispatching -----
+
+struct Kernels {
+    LineScanner::Level level;
+    int (*lineStarts)(const char *, int, char, int, QVector<int> &);
+    int (*count)(const char *, int, char);
+    int (*nextLineBreak)(const char *, int, int);
+};
+
+static LineScanner::Level maxLevel()
+{
+#ifdef LINESCANNER_X86
+    static const LineScanner::Level level = cpuHasAvx2() ? LineScanner::AVX2 : LineScanner::SSE2;
+    return level;
+#else
+    return LineScanner::Scalar;
+#endif
+}
+
+static Kernels kernelsFor(LineScanner::Level level)
+{
+    level = qMin(level, maxLevel());
+#ifdef LINESCANNER_X86
+    if (level == LineScanner::AVX2)
+        return Kernels {LineScanner::AVX2, &lineStartsAvx2, &countAvx2, &nextLineBreakAvx2};
+    if (level == LineScanner::SSE2)
+        return Kernels {LineScanner::SSE2, &lineStartsSse2, &countSse2, &nextLineBreakSse2};
+#endif
+    return Kernels {LineScanner::Scalar, &lineStartsScalar, &countScalar, &nextLineBreakScalar};
+}
+
+// the index workers read the level while a test or benchmark may change it
+static QAtomicInt &currentLevel()
+{
+    static QAtomicInt res(maxLevel());
+    return res;
+}
+
+static const Kernels &kernels()
+{
+    static const Kernels res[] = {kernelsFor(LineScanner::Scalar), kernelsFor(LineScanner::SSE2),
+                                  kernelsFor(LineScanner::AVX2)};
+    return res[currentLevel().loadAcquire()];
+}
+
+int LineScanner::lineStarts(const char *data, int size, char delim, int shift, QVector<int> &lineStarts)
+{
+    if (size <= 0) return 0;
+    return kernels().lineStarts(data, size, delim, shift, lineStarts);
+}
+
+int LineScanner::count(const char *data, int size, char delim)
+{
+    if (size <= 0) return 0;
+    return kernels().count(data, size, delim);
+}
+
+int LineScanner::nextLineBreak(const char *data, int from, int size)
+{
+    if (from < 0 || from >= size) return -1;
+    return kernels().nextLineBreak(data, from, size);
+}
+
+LineScanner::Level LineScanner::level()
+{
+    return kernels().level;
+}
+
+void LineScanner::setLevel(LineScanner::Level level)
+{
+    currentLevel().storeRelease(kernelsFor(level).level);
+}
+
+QString LineScanner::levelName()
+{
+    switch (level()) {
+    case AVX2: return "AVX2";
+    case SSE2: return "SSE2";
+    default: return "scalar";
+    }
+}
+
+} // namespace studio
+} // namespace gams
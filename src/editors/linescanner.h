@@ -0,0 +1,60 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LINESCANNER_H
+#define LINESCANNER_H
+
+#include <QVector>
+#include <QString>
+
+namespace gams {
+namespace studio {
+
+///
+/// class LineScanner
+/// Scans raw text data for line breaks. Uses AVX2 or SSE2 if supported by the CPU, otherwise a scalar fallback.
+///
+class LineScanner
+{
+public:
+    enum Level { Scalar, SSE2, AVX2 };
+
+    /// Appends (index + shift) of each occurrence of delim in data[0..size) to lineStarts.
+    static int lineStarts(const char *data, int size, char delim, int shift, QVector<int> &lineStarts);
+
+    /// Counts the occurrences of delim in data[0..size).
+    static int count(const char *data, int size, char delim);
+
+    /// Returns the index of the next CR or LF in data[from..size) or -1 if there is none.
+    static int nextLineBreak(const char *data, int from, int size);
+
+    static Level level();
+    /// Selects the kernels to test and benchmark them, the level is bound by the CPU's capabilities. The level is
+    /// atomic, scans that already run keep their kernels.
+    static void setLevel(Level level);
+    static QString levelName();
+
+private:
+    LineScanner() {}
+};
+
+} // namespace studio
+} // namespace gams
+
+#endif // LINESCANNER_H
@@ -20,7 +20,6 @@
 #include "logparser.h"
 //#include "file.h"
 #include <QTextCodec>
-#include <QDir>
 #include "logger.h"
 
 namespace gams {
@@ -61,7 +60,7 @@ void LogParser::quickParse(const QByteArray &data, int start, int end, QString &
         case '\"': if (inQuote != 1) inQuote = inQuote? 0 : 2; break;
         case '[':
             if (!inQuote) {
-                if (data.at(i+4) == ':') {
+                if (i+4 < end && data.at(i+4) == ':') {
                     cutEnd = i;
                     if (linkStart < 0) linkStart = i;
                     if (i-1 > start && data.at(i-1) == ']') {
@@ -157,12 +156,10 @@ QString LogParser::extractLinks(const QString &line, bool &hasError, LogParser::
 
                 // FIL + REF
             } else if (line.midRef(posB+1,4) == "FIL:" || line.midRef(posB+1,4) == "REF:") {
-                QString fName = QDir::fromNativeSeparators(capture(line, posA, posB, 6, '"').toString());
+                capture(line, posA, posB, 6, '"');
                 ++posB;
                 mbState.marks.setMark(line.mid(start, posB-start));
 
-                bool fileExists = false;
-                emit hasFile(fName, fileExists);
                 capture(line, posA, posB, 1, ']');
                 ++posB;
 
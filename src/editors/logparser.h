@@ -60,7 +60,6 @@ public:
 
 signals:
     void setErrorText(int lstLine, QString text);
-    void hasFile(QString fName, bool &exists);
 
 private:
     QString extractLinks(const QString &line, bool &hasError, MarksBlockState &mbState);
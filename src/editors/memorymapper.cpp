@@ -18,8 +18,10 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "memorymapper.h"
+#include "linescanner.h"
 #include "file/dynamicfile.h"
 #include "logger.h"
+#include <QtConcurrent>
 
 namespace gams {
 namespace studio {
@@ -30,13 +32,16 @@ static int CDirectErrors = 3;       // The count of errors created immediately
 static int CParseLinesMax = 23;     // The maximum count of gathered lines befor updating the display
 static int CRefreshTimeMax = 100;    // The maximum time (in ms) to wait until the output is updated (after changed)
 static int CKeptRunCount = 5;
+static int CHotChunks = 4;          // The count of recently used chunks kept uncompressed
+static int CPackLevel = 1;          // The zlib compression level for cold chunks (fastest)
 
 MemoryMapper::MemoryMapper(QObject *parent) : AbstractTextMapper (parent)
 {
     mRunFinishedTimer.setInterval(10);
     mRunFinishedTimer.setSingleShot(true);
-    mNewLogLines.reserve(CParseLinesMax+1);
+    mParseItems.reserve(CParseLinesMax+1);
     connect(&mRunFinishedTimer, &QTimer::timeout, this, &MemoryMapper::runFinished);
+    connect(&mParseWatcher, &QFutureWatcher<ParseResult>::finished, this, &MemoryMapper::parseFinished);
     connect(&mPendingTimer, &QTimer::timeout, this, &MemoryMapper::processPending);
     mPendingTimer.setSingleShot(true);
     mPending = PendingNothing;
@@ -74,14 +79,39 @@ MemoryMapper::MemoryMapper(QObject *parent) : AbstractTextMapper (parent)
 
 MemoryMapper::~MemoryMapper()
 {
+    if (mParseBusy) mParseWatcher.waitForFinished();
+    mParseBusy = false;
+    mParseItems.clear();
     while (!mChunks.isEmpty())
         removeChunk(mChunks.last()->nr);
 
     setLogParser(nullptr);
 }
 
+void MemoryMapper::setMemoryBudget(qint64 bytes)
+{
+    mMemoryBudget = bytes;
+    releaseChunks();
+}
+
+qint64 MemoryMapper::memoryBudget() const
+{
+    return mMemoryBudget;
+}
+
+qint64 MemoryMapper::memoryUsage() const
+{
+    // the line starts of cold chunks are compressed with their data, each chunk keeps only the first and the last
+    qint64 res = mPackedBytes + qint64(mChunks.size()) * qint64(sizeof(Chunk) + 2*sizeof(int))
+            + qint64(mColdChunks.size()) * qint64(sizeof(ColdChunk) + sizeof(Chunk*));
+    for (const Chunk *chunk : mHotChunks)
+        res += chunkSize() + qint64(chunk->lineBytes.capacity()) * qint64(sizeof(int));
+    return res;
+}
+
 void MemoryMapper::setLogParser(LogParser *parser)
 {
+    finishParsing();
     if (mLogParser) delete mLogParser;
     mLogParser = parser;
 }
@@ -121,11 +151,11 @@ AbstractTextMapper::Chunk *MemoryMapper::addChunk(bool startUnit)
     chunk->lineBytes << 0;
     chunk->nr = chunkCount();
     mChunks << chunk;
+    mHotChunks << chunk;
     invalidateLineOffsets(chunk);
 
     if (startUnit || !mUnits.size()) {
         mUnits << Unit(mChunks.last());
-        mShrinkLineCount = 0;
     }
     ++mUnits.last().chunkCount;
     while (mUnits.count() > CKeptRunCount) {
@@ -134,64 +164,6 @@ AbstractTextMapper::Chunk *MemoryMapper::addChunk(bool startUnit)
     return mChunks.last();
 }
 
-void MemoryMapper::shrinkLog(qint64 minBytes)
-{
-    const QByteArray ellipsis(QString("\n...\n\n").toLatin1().data());
-
-    Chunk * chunk = mUnits.last().firstChunk;
-    if (chunk->nr == mChunks.last()->nr || chunk->lineCount() < 2)
-        return; // only one chunk in current unit
-
-    if (!mShrinkLineCount) {
-        // the first chunk in the unit starts at bArray[0]
-        while (chunk->size()+ellipsis.size() > chunkSize() && chunk->lineBytes.size() > 1) {
-            chunk->lineBytes.removeLast();
-        }
-        // replace last line of first chunk by an ellipsis
-        invalidateSize();
-        chunk->bArray.replace(chunk->lineBytes.last(), ellipsis.length(), ellipsis);
-        chunk->lineBytes << (chunk->lineBytes.last()+1) << (chunk->lineBytes.last() + ellipsis.length()-1)
-                             << (chunk->lineBytes.last() + ellipsis.length());
-        updateChunkMetrics(chunk);
-    }
-
-    // remove some lines at the start of the second active chunk
-    chunk = mChunks[chunk->nr+1];
-    int linesToRemove = 1;
-    while (minBytes > chunk->lineBytes.at(linesToRemove)) {
-        ++linesToRemove;
-        if (linesToRemove > chunk->lineCount()) break;
-    }
-    invalidateSize();
-    chunk->lineBytes.remove(0, linesToRemove);
-    mShrinkLineCount += linesToRemove;
-
-    // remove chunk if it is empty
-    if (!chunk->size()) {
-        Chunk *delChunk = chunk;
-        chunk = (mChunks.size() > chunk->nr+1) ? mChunks.at(chunk->nr+1) : nullptr;
-        removeChunk(delChunk->nr);
-        if (chunk)
-            updateChunkMetrics(chunk, true);
-    }
-
-    // update internal data to new sizes
-    while (chunk) {
-        updateChunkMetrics(chunk);
-        chunk = (mChunks.size() > chunk->nr+1) ? mChunks.at(chunk->nr+1) : nullptr;
-    }
-    recalcLineCount();
-}
-
-bool MemoryMapper::ensureSpace(qint64 bytes)
-{
-    if (size() - mUnits.last().firstChunk->bStart + bytes >= chunkSize() * 2) {
-        shrinkLog(bytes);
-        return true;
-    }
-    return false;
-}
-
 void MemoryMapper::recalcLineCount()
 {
     int lineCount = 0;
@@ -216,19 +188,9 @@ MemoryMapper::LineRef MemoryMapper::logLineToRef(const int &lineNr)
     LineRef res;
     res.chunk = mUnits.last().firstChunk;
     res.relLine = lineNr;
-
-    // takes care of possible ellipsis in first chunk of the run
-    int headLines = mShrinkLineCount ? res.chunk->lineCount()-3 : res.chunk->lineCount();
-
-    // if line is in first chunk (before ellipsis)
-    if (res.relLine < headLines) return res;
-
-    res.relLine = lineNr - mShrinkLineCount;
-    while (res.relLine >= res.chunk->lineCount()) {
-        res.relLine -= headLines;
+    while (res.chunk && res.relLine >= res.chunk->lineCount()) {
+        res.relLine -= res.chunk->lineCount();
         res.chunk = nextChunk(res.chunk);
-        if (!res.chunk) break;
-        headLines = res.chunk->lineCount();
     }
     return res;
 }
@@ -236,16 +198,14 @@ MemoryMapper::LineRef MemoryMapper::logLineToRef(const int &lineNr)
 AbstractTextMapper::Chunk *MemoryMapper::nextChunk(AbstractTextMapper::Chunk *chunk)
 {
     if (!chunk) return nullptr;
-    int i = mChunks.indexOf(chunk);
-    if (i+1 < mChunks.size()) return mChunks.at(i+1);
+    if (chunk->nr+1 < mChunks.size()) return mChunks.at(chunk->nr+1);
     return nullptr;
 }
 
 AbstractTextMapper::Chunk *MemoryMapper::prevChunk(AbstractTextMapper::Chunk *chunk)
 {
     if (!chunk) return nullptr;
-    int i = mChunks.indexOf(chunk);
-    if (i > 0) return mChunks.at(i-1);
+    if (chunk->nr > 0) return mChunks.at(chunk->nr-1);
     return nullptr;
 }
 
@@ -257,7 +217,7 @@ int MemoryMapper::currentRunLines()
         res += chunk->lineCount();
         chunk = nextChunk(chunk);
     }
-    return mShrinkLineCount ? res + mShrinkLineCount - 3 : res;
+    return res;
 }
 
 void MemoryMapper::updateChunkMetrics(Chunk *chunk, bool cutRemain)
@@ -276,13 +236,15 @@ int MemoryMapper::lineCount() const
 
 void MemoryMapper::startRun()
 {
+    finishParsing();
     addChunk(true);         // prepare chunk and unit for new run
     mMarkers.clear();       // LineRefs to remembered marks of current run (persists until next run)
     mMarksHead.clear();     // temp top lines with marks (converted to markers at end of run)
     mMarksTail.clear();     // temp bottom lines with marks (converted to markers at end of run)
-    mShrinkLineCount = 0;   // count of lines removed by shrinking
 
-    mErrCount = 0;
+    mParseState.errCount = 0;
+    mParseState.lastHeadLine = -1;
+    mParseState.lastTailLine = -1;
     mInstantRefresh = false;
     mNewLines = 0;
     appendEmptyLine();
@@ -293,7 +255,7 @@ void MemoryMapper::endRun()
     processPending();
     mLastLineLen = 0;
     mLastLineIsOpen = false;
-    fetchLog();
+    finishParsing();
     runFinished();
 //    dump();
 }
@@ -326,40 +288,26 @@ void MemoryMapper::runFinished()
     }
 
     for (int i = CDirectErrors; i < mMarkers.size(); ++i) {
-        createErrorMarks(mMarkers.at(i), true);
+        // compile-time errors have descriptions in the following lines
+        ParseItem item;
+        item.kind = ParseItem::ErrorBlock;
+        item.data = lineData(mMarkers.at(i));
+        LineRef ref = nextRef(mMarkers.at(i));
+        QByteArray data = lineData(ref);
+        while (data.startsWith("   ")) {
+            item.descr << data;
+            ref = nextRef(ref);
+            data = lineData(ref);
+        }
+        mParseItems << item;
     }
+    startParsing();
 
     mMarksHead.clear();
     mMarksTail.clear();
     recalcLineCount();
 }
 
-void MemoryMapper::createErrorMarks(MemoryMapper::LineRef ref, bool readErrorText)
-{
-    QByteArray data = lineData(ref);
-    QString rawLine;
-    bool hasError = false;
-    LogParser::MarksBlockState mbState;
-    QString line = mLogParser->parseLine(data, rawLine, hasError, mbState);
-    LogParser::MarksBlockState mbFollowState = mbState;
-    if (readErrorText && mbState.errData.errNr > 0) {
-        // compile-time error have descriptions in the following lines
-        while (true) {
-            ref = nextRef(ref);
-            data = lineData(ref);
-            if (!data.startsWith("   ")) break;
-            if (mbState.errData.text.isEmpty()) {
-                mbState.errData.text.append(QString("%1\t").arg(mbState.errData.errNr));
-            } else
-                mbState.errData.text.append("\n\t");
-            mbState.errData.text += data.trimmed();
-        }
-        if (!mbState.errData.text.isEmpty())
-            emit mLogParser->setErrorText(mbState.errData.lstLine, mbState.errData.text);
-    }
-    emit createMarks(mbState.marks);
-}
-
 void MemoryMapper::appendLineData(const QByteArray &data, Chunk *&chunk)
 {
     if (!chunk->lineCount())
@@ -401,78 +349,23 @@ void MemoryMapper::parseNewLine()
         return;
     int start = chunk->lineBytes.at(chunk->lineCount()-1);
     int end = chunk->lineBytes.last()-1; // -1 to skip the trailing LF
+    int len = end - start;
 
-    QString line;
-    int lastLinkStart = -1;
-//    LineFormat fmt;
-    int lstLine = -1;
-    mLogParser->quickParse(chunk->bArray, start, end, line, lastLinkStart, lstLine);
-    if (mCurrentLstLineRef >= 0) {
-        if (end >= start+3 && chunk->bArray.at(start)==' ') {
-            if (mCurrentErrText.isEmpty()) {
-                mCurrentErrText.append(mCurrentErrorNr >= 0 ? QString("%1\t").arg(mCurrentErrorNr) : "\t");
-            } else {
-                mCurrentErrText.append("\n\t");
-            }
-            mCurrentErrText += line.trimmed();
-        } else {
-            emit mLogParser->setErrorText(mCurrentLstLineRef, mCurrentErrText);
-            mCurrentErrText.clear();
-            mCurrentLstLineRef = -1;
-            mCurrentErrorNr = -1;
-        }
-    }
-    if (mErrCount < CDirectErrors && lstLine >= 0) {
-        mCurrentLstLineRef = lstLine;
-        if (line.startsWith("*** Error ") && line.length() > 25) {
-            int i = 9;
-            while (line.size() > i+1 && line.at(i+1) == ' ') ++i;
-            int len = 0;
-            while (line.size() > i+len+1 && line.at(i+len+1) >= '0' && line.at(i+len+1) <= '9') ++len;
-            bool ok = false;
-            if (len > 0) mCurrentErrorNr = line.mid(i, len+1).toInt(&ok);
-            if (!ok) mCurrentErrorNr = -1;
-        }
-    }
-
-    if (lastLinkStart >= start) {
-        if (lastLinkStart > start+line.length() || line.startsWith("*** Error")) {
-//            fmt = LineFormat(4, line.length(), mBaseFormat.at(error));
-//            if (lastLinkStart > start+line.length()) {
-//                fmt.extraLstFormat = &mBaseFormat.at(lstLink);
-//            }
-            int lineNr = currentRunLines();
-            if (mErrCount < CErrorBound) {
-                if (mMarksHead.isEmpty() || mMarksHead.last() != lineNr) {
-                    mMarksHead << lineNr;
-                    if (mErrCount < CDirectErrors) {
-                        createErrorMarks(logLineToRef(lineNr), false);
-                    }
-                    ++mErrCount;
-                }
-            } else if (!mMarksTail.size() || mMarksTail.last() != lineNr) {
-                ++mErrCount;
-                mMarksTail.append(lineNr);
-            }
-//        } else if (chunk->bArray.mid(start+line.length()+1, 3) == "LST") {
-//            fmt = LineFormat(4, line.length(), mBaseFormat.at(lstLink));
-//        } else {
-//            fmt = LineFormat(4, line.length(), mBaseFormat.at(fileLink));
-        }
-    }
+    // the parser works on a copy of the line, only lines with a link need the line number
+    ParseItem item;
+    item.data = chunk->bArray.mid(start, len);
+    if (len && item.data.at(len-1) == ']')
+        item.lineNr = currentRunLines();
+    item.toLog = !mLastLineIsOpen || mLastLineLen != len;
+    mParseItems << item;
 
-    // update log-file cache
-    if (!mLastLineIsOpen || mLastLineLen != line.length())
-        mNewLogLines << line;
-
-    if (mLastLineIsOpen && mLastLineLen > line.length()) {
-        ensureSpace(1);
+    if (mLastLineIsOpen && mLastLineLen > len) {
         appendEmptyLine();
         mLastLineLen = 0;
         mLastLineIsOpen = false;
     }
 
-    mLastLineLen = line.length();
+    mLastLineLen = len;
     if (mInstantRefresh) {
         // last line has to be overwritten - update immediately
         processPending();
@@ -480,10 +373,150 @@ void MemoryMapper::parseNewLine()
     ++mNewLines;
 }
 
+void MemoryMapper::startParsing()
+{
+    if (mParseBusy || mParseItems.isEmpty()) return;
+    if (!mLogParser) {
+        mParseItems.clear();
+        return;
+    }
+    QVector<ParseItem> items;
+    items.reserve(CParseLinesMax+1);
+    items.swap(mParseItems);
+    mParseBusy = true;
+    mParseWatcher.setFuture(QtConcurrent::run(&MemoryMapper::parseItems, mLogParser, &mParseState, items));
+}
+
+void MemoryMapper::finishParsing()
+{
+    while (mParseBusy || !mParseItems.isEmpty()) {
+        startParsing();
+        if (!mParseBusy) break;
+        mParseWatcher.waitForFinished();
+        mParseBusy = false;
+        applyParseResult(mParseWatcher.result());
+    }
+}
+
+void MemoryMapper::parseFinished()
+{
+    // the result may already be applied by finishParsing()
+    if (!mParseBusy || !mParseWatcher.isFinished()) return;
+    mParseBusy = false;
+    applyParseResult(mParseWatcher.result());
+    if (mParseItems.size() >= CParseLinesMax)
+        startParsing();
+}
+
+void MemoryMapper::applyParseResult(const ParseResult &result)
+{
+    for (const LogParser::ErrorData &err : result.errors)
+        emit mLogParser->setErrorText(err.lstLine, err.text);
+    for (const LogParser::MarkData &marks : result.marks)
+        emit createMarks(marks);
+    mMarksHead << result.headLines;
+    for (const int &lineNr : result.tailLines)
+        mMarksTail.append(lineNr);
+    if (!result.logLines.isEmpty())
+        emit appendLines(result.logLines);
+}
+
+MemoryMapper::ParseResult MemoryMapper::parseItems(LogParser *parser, ParseState *state,
+                                                   const QVector<ParseItem> &items)
+{
+    // runs in a worker thread: only the parser, the state and the items are accessed here
+    ParseResult res;
+    for (const ParseItem &item : items) {
+        if (item.kind == ParseItem::ErrorBlock) {
+            QString rawLine;
+            bool hasError = false;
+            LogParser::MarksBlockState mbState;
+            parser->parseLine(item.data, rawLine, hasError, mbState);
+            if (mbState.errData.errNr > 0) {
+                for (const QByteArray &descr : item.descr) {
+                    if (mbState.errData.text.isEmpty()) {
+                        mbState.errData.text.append(QString("%1\t").arg(mbState.errData.errNr));
+                    } else
+                        mbState.errData.text.append("\n\t");
+                    mbState.errData.text += descr.trimmed();
+                }
+                if (!mbState.errData.text.isEmpty())
+                    res.errors << mbState.errData;
+            }
+            res.marks << mbState.marks;
+            continue;
+        }
+
+        QString line;
+        int lastLinkStart = -1;
+        int lstLine = -1;
+        parser->quickParse(item.data, 0, item.data.length(), line, lastLinkStart, lstLine);
+        if (state->currentLstLineRef >= 0) {
+            if (item.data.length() >= 3 && item.data.at(0) == ' ') {
+                if (state->currentErrText.isEmpty()) {
+                    state->currentErrText.append(state->currentErrorNr >= 0 ? QString("%1\t").arg(state->currentErrorNr)
+                                                                            : "\t");
+                } else {
+                    state->currentErrText.append("\n\t");
+                }
+                state->currentErrText += line.trimmed();
+            } else {
+                LogParser::ErrorData err;
+                err.lstLine = state->currentLstLineRef;
+                err.text = state->currentErrText;
+                res.errors << err;
+                state->currentErrText.clear();
+                state->currentLstLineRef = -1;
+                state->currentErrorNr = -1;
+            }
+        }
+        if (state->errCount < CDirectErrors && lstLine >= 0) {
+            state->currentLstLineRef = lstLine;
+            if (line.startsWith("*** Error ") && line.length() > 25) {
+                int i = 9;
+                while (line.size() > i+1 && line.at(i+1) == ' ') ++i;
+                int len = 0;
+                while (line.size() > i+len+1 && line.at(i+len+1) >= '0' && line.at(i+len+1) <= '9') ++len;
+                bool ok = false;
+                if (len > 0) state->currentErrorNr = line.mid(i, len+1).toInt(&ok);
+                if (!ok) state->currentErrorNr = -1;
+            }
+        }
+
+        if (lastLinkStart >= 0 && item.lineNr >= 0) {
+            if (lastLinkStart > line.length() || line.startsWith("*** Error")) {
+                if (state->errCount < CErrorBound) {
+                    if (state->lastHeadLine != item.lineNr) {
+                        state->lastHeadLine = item.lineNr;
+                        res.headLines << item.lineNr;
+                        if (state->errCount < CDirectErrors) {
+                            QString rawLine;
+                            bool hasError = false;
+                            LogParser::MarksBlockState mbState;
+                            parser->parseLine(item.data, rawLine, hasError, mbState);
+                            res.marks << mbState.marks;
+                        }
+                        ++state->errCount;
+                    }
+                } else if (state->lastTailLine != item.lineNr) {
+                    state->lastTailLine = item.lineNr;
+                    res.tailLines << item.lineNr;
+                    ++state->errCount;
+                }
+            }
+        }
+
+        // update log-file cache
+        if (item.toLog)
+            res.logLines << line;
+    }
+    return res;
+}
+
 void MemoryMapper::appendEmptyLine()
 {
-    if (mNewLogLines.length() >= CParseLinesMax)
-        fetchLog();
+    if (mParseItems.size() >= CParseLinesMax)
+        startParsing();
 
     // update chunk (switch to new if filled up)
     Chunk *chunk = mChunks.last();
@@ -518,12 +551,6 @@ void MemoryMapper::clearLastLine()
     mLastLineLen = 0;
 }
 
-void MemoryMapper::fetchLog()
-{
-    emit appendLines(mNewLogLines);
-    mNewLogLines.clear();
-}
-
 void MemoryMapper::fetchDisplay()
 {
     emit updateView();
@@ -548,6 +575,7 @@ void MemoryMapper::newPending(MemoryMapper::Pending pending)
 void MemoryMapper::processPending()
 {
     mPendingTimer.stop();
+    startParsing();
     if (mPending.testFlag(PendingBlockCountChange)) {
         emitBlockCountChanged();
     }
@@ -564,10 +592,10 @@ void MemoryMapper::addProcessData(const QByteArray &data)
     int len = 0;
     int start = 0;
     QByteArray midData;
-    bool cleaned = false;
 
-    for (int i = 0 ; i < data.length() ; ++i) {
-        // check for line breaks
+    // jump from line break to line break
+    int i = LineScanner::nextLineBreak(data.constData(), 0, data.length());
+    while (i >= 0) {
         if (data.at(i) == '\r') {
             len = i-start;
             if (i+1 < data.size() && data.at(i+1) == '\n') {
@@ -575,13 +603,10 @@ void MemoryMapper::addProcessData(const QByteArray &data)
                 ++i;
                 if (len) {
                     midData.setRawData(data.data()+start, uint(len));
-                    cleaned = ensureSpace(midData.size()+1);
                     chunk = mChunks.last();
                     appendLineData(midData, chunk);
                 }
                 start = i + 1;
-                cleaned = ensureSpace(1);
-                chunk = mChunks.last();
                 appendEmptyLine();
             } else {
                 // concealing standalone CR - "\r"
@@ -597,30 +622,27 @@ void MemoryMapper::addProcessData(const QByteArray &data)
             len = i-start;
             if (len) {
                 midData.setRawData(data.data()+start, uint(len));
-                cleaned = ensureSpace(midData.size()+1);
                 chunk = mChunks.last();
                 appendLineData(midData, chunk);
             }
             start = i + 1;
-            cleaned = ensureSpace(1);
-            chunk = mChunks.last();
             appendEmptyLine();
         }
+        i = LineScanner::nextLineBreak(data.constData(), i+1, data.length());
     }
     if (start < data.length()) {
         len = data.length()-start;
         if (len) {
             midData.setRawData(data.data()+start, uint(len));
-            cleaned = ensureSpace(midData.size()+1);
             chunk = mChunks.last();
             appendLineData(midData, chunk);
             mLastLineIsOpen = true;
         }
     }
-    if (!cleaned) {
-        updateChunkMetrics(chunk);
-        recalcLineCount();
-    }
+    chunk = mChunks.last();
+    updateChunkMetrics(chunk);
+    recalcLineCount();
+    releaseChunks();
 }
 
 void MemoryMapper::reset()
@@ -728,7 +750,7 @@ void MemoryMapper::dump()
 {
 //    int iCh = 0;
     DEB() << "\n";
-    DEB() << "---- size: " << mSize << "  lineCount: " << lineCount();
+    DEB() << "---- size: " << mSize << "  lineCount: " << lineCount() << "  memory: " << memoryUsage();
     int sum = 0;
     for (Chunk *chunk : mChunks) {
 //        for (int lineNr = 0; lineNr < chunk->lineBytes.size()-1; ++lineNr) {
@@ -762,13 +784,14 @@ int MemoryMapper::knownLineNrs() const
 QString MemoryMapper::extractLstRef(LineRef lineRef)
 {
     if (!lineRef.chunk) return QString();
+    const QByteArray &data = chunkData(lineRef.chunk);
     int lastCh = lineRef.chunk->lineBytes.at(lineRef.relLine+1)-2;
     if (lastCh - lineRef.chunk->lineBytes.at(lineRef.relLine) < 7) return QString();
-    if (lineRef.chunk->bArray.at(lastCh) != ']') return QString();
+    if (data.at(lastCh) != ']') return QString();
     int firstCh = lastCh-1;
-    while (firstCh >= lineRef.chunk->lineBytes.at(lineRef.relLine) && lineRef.chunk->bArray.at(firstCh) != '[')
+    while (firstCh >= lineRef.chunk->lineBytes.at(lineRef.relLine) && data.at(firstCh) != '[')
         --firstCh;
-    QString res = lineRef.chunk->bArray.mid(firstCh+1, lastCh-firstCh-1);
+    QString res = data.mid(firstCh+1, lastCh-firstCh-1);
     if (!res.startsWith("LST:")) return QString();
     return res;
 }
@@ -787,12 +810,10 @@ QString MemoryMapper::findClosestLst(const int &localLine)
         return QString();
     LineRef foreRef = backRef;
     // take previous line while in error description (line starts with space)
-    while(backRef.chunk &&
-          backRef.chunk->bArray.at(backRef.chunk->lineBytes.at(backRef.relLine)) == ' ')
+    while(backRef.chunk && lineData(backRef).startsWith(' '))
         backRef = prevRef(backRef);
     // take next line while in error description (line starts with space)
-    while(foreRef.chunk &&
-          foreRef.chunk->bArray.at(foreRef.chunk->lineBytes.at(foreRef.relLine)) == ' ')
+    while(foreRef.chunk && lineData(foreRef).startsWith(' '))
         foreRef = nextRef(foreRef);
 
     // look for next lst-link in both directions
@@ -842,6 +863,14 @@ void MemoryMapper::internalRemoveChunk(int chunkNr)
     if (delUnit >= 0)
         mUnits.remove(delUnit);
     // remove chunk and adjust chunk-numbers
+    mHotChunks.removeOne(chunk);
+    if (mColdChunks.contains(chunk)) {
+        mPackedBytes -= mColdChunks.value(chunk).packed.size();
+        mPackedChunks.removeOne(chunk);
+        mColdChunks.remove(chunk);
+        if (mColdChunks.isEmpty() && mSpillFile.isOpen())
+            mSpillFile.resize(0);
+    }
     mChunks.removeAt(chunkNr);
     for (int i = chunkNr; i < mChunks.size(); ++i) {
         --mChunks[i]->nr;
@@ -863,11 +892,118 @@ int MemoryMapper::visibleLineCount() const
 AbstractTextMapper::Chunk *MemoryMapper::getChunk(int chunkNr, bool cache) const
 {
     Q_UNUSED(cache)
-    if (chunkNr >= 0 && mChunks.size() > chunkNr)
-        return mChunks.at(chunkNr);
+    if (chunkNr >= 0 && mChunks.size() > chunkNr) {
+        Chunk *chunk = mChunks.at(chunkNr);
+        chunkData(chunk);
+        return chunk;
+    }
     return nullptr;
 }
 
+const QByteArray &MemoryMapper::chunkData(Chunk *chunk) const
+{
+    if (chunk->bArray.isEmpty()) {
+        // the chunk is cold: decompress the data kept in memory or in the spill file
+        const ColdChunk &cold = mColdChunks[chunk];
+        QByteArray packed = cold.packed;
+        if (packed.isEmpty() && mSpillFile.seek(cold.filePos))
+            packed = mSpillFile.read(cold.fileSize);
+        chunk->bArray = qUncompress(packed);
+        int dataSize = chunk->lineBytes.last();
+        if (chunk->bArray.size() != dataSize + chunk->packedLines * int(sizeof(int))) {
+            DEB() << "Error restoring process log data of chunk " << chunk->nr;
+            chunk->bArray.fill(' ', dataSize + chunk->packedLines * int(sizeof(int)));
+        }
+        // the line lengths follow the data
+        QVector<int> lengths(chunk->packedLines);
+        memcpy(lengths.data(), chunk->bArray.constData() + dataSize, size_t(lengths.size()) * sizeof(int));
+        QVector<int> lineBytes;
+        lineBytes.reserve(chunk->packedLines + 1);
+        lineBytes << chunk->lineBytes.first();
+        for (int length : lengths)
+            lineBytes << lineBytes.last() + length;
+        if (lineBytes.last() != dataSize) {
+            DEB() << "Error restoring process log lines of chunk " << chunk->nr;
+            lineBytes.resize(chunk->packedLines);
+            lineBytes << dataSize;
+        }
+        chunk->lineBytes = lineBytes;
+        chunk->packedLines = -1;
+        chunk->bArray.resize(chunkSize());
+        mHotChunks << chunk;
+        releaseChunks();
+    } else if (mHotChunks.isEmpty() || mHotChunks.last() != chunk) {
+        mHotChunks.removeOne(chunk);
+        mHotChunks << chunk;
+    }
+    return chunk->bArray;
+}
+
+void MemoryMapper::packChunk(Chunk *chunk) const
+{
+    // only the last chunk is modified, so the data of any other chunk is compressed once
+    int lines = chunk->lineCount();
+    if (!mColdChunks.contains(chunk)) {
+        // the line lengths are compressed with the data
+        int dataSize = chunk->lineBytes.last();
+        QVector<int> lengths(lines);
+        for (int i = 0; i < lines; ++i)
+            lengths[i] = chunk->lineBytes.at(i+1) - chunk->lineBytes.at(i);
+        chunk->bArray.resize(dataSize + lines * int(sizeof(int)));
+        memcpy(chunk->bArray.data() + dataSize, lengths.constData(), size_t(lines) * sizeof(int));
+        ColdChunk cold;
+        cold.packed = qCompress(chunk->bArray, CPackLevel);
+        mPackedBytes += cold.packed.size();
+        mPackedChunks << chunk;
+        mColdChunks.insert(chunk, cold);
+    }
+    invalidateDecodedChunks(chunk->nr);
+    chunk->bArray = QByteArray();
+    chunk->lineBytes = QVector<int>() << chunk->lineBytes.first() << chunk->lineBytes.last();
+    chunk->packedLines = lines;
+}
+
+bool MemoryMapper::spillChunk(Chunk *chunk) const
+{
+    ColdChunk &cold = mColdChunks[chunk];
+    if (cold.filePos < 0) {
+        if (!mSpillFile.isOpen() && !mSpillFile.open()) {
+            DEB() << "Error creating temporary file for process log";
+            return false;
+        }
+        qint64 pos = mSpillFile.size();
+        if (!mSpillFile.seek(pos) || mSpillFile.write(cold.packed) != cold.packed.size()) {
+            DEB() << "Error writing process log to " << mSpillFile.fileName();
+            return false;
+        }
+        cold.filePos = pos;
+        cold.fileSize = cold.packed.size();
+    }
+    mPackedBytes -= cold.packed.size();
+    cold.packed = QByteArray();
+    mPackedChunks.removeOne(chunk);
+    return true;
+}
+
+void MemoryMapper::releaseChunks() const
+{
+    // compress the least recently used chunks, the tail is kept as it is still growing
+    int i = 0;
+    while (mHotChunks.size() > CHotChunks && i < mHotChunks.size()) {
+        Chunk *chunk = mHotChunks.at(i);
+        if (chunk == mChunks.last()) {
+            ++i;
+            continue;
+        }
+        packChunk(chunk);
+        mHotChunks.removeAt(i);
+    }
+    // move the oldest compressed data to the spill file while exceeding the memory budget
+    while (memoryUsage() > mMemoryBudget && !mPackedChunks.isEmpty()) {
+        if (!spillChunk(mPackedChunks.first())) break;
+    }
+}
+
 MemoryMapper::LineRef MemoryMapper::nextRef(const MemoryMapper::LineRef &ref)
 {
     if (!ref.chunk) return LineRef();
@@ -897,11 +1033,12 @@ MemoryMapper::LineRef MemoryMapper::prevRef(const MemoryMapper::LineRef &ref)
 QByteArray MemoryMapper::lineData(const MemoryMapper::LineRef &ref)
 {
     if (!ref.chunk) return QByteArray();
+    const QByteArray &data = chunkData(ref.chunk);
     int byteFrom = ref.chunk->lineBytes.at(ref.relLine);
     int byteTo = ref.chunk->lineBytes.at(ref.relLine+1);
-    while ((ref.chunk->bArray.at(byteTo) == '\n' || ref.chunk->bArray.at(byteTo) == '\r') && byteTo > byteFrom)
+    while ((data.at(byteTo) == '\n' || data.at(byteTo) == '\r') && byteTo > byteFrom)
         --byteTo;
-    return ref.chunk->bArray.mid(byteFrom, byteTo - byteFrom -1);
+    return data.mid(byteFrom, byteTo - byteFrom -1);
 }
 
 } // namespace studio
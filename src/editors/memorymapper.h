@@ -25,6 +25,8 @@
 #include <QMutex>
 #include <QTime>
 #include <QTimer>
+#include <QFutureWatcher>
+#include <QTemporaryFile>
 
 namespace gams {
 namespace studio {
@@ -52,11 +54,40 @@ private: // types
         int chunkCount = 0;
         bool folded = false;
     };
+    struct ColdChunk {
+        QByteArray packed;          // the compressed data while kept in memory
+        qint64 filePos = -1;        // the position of the compressed data in the spill file
+        int fileSize = 0;
+    };
     struct LineRef {
         Chunk *chunk = nullptr;
         int relLine = 0;
     };
 
+    struct ParseItem {
+        enum Kind { Line, ErrorBlock };
+        Kind kind = Line;
+        QByteArray data;            // the raw line without line break
+        QList<QByteArray> descr;    // ErrorBlock: the following lines describing the error
+        int lineNr = -1;            // Line: the line nr in the current run (only for lines that may contain links)
+        bool toLog = true;          // Line: append the line to the log-file cache
+    };
+    struct ParseState {
+        int errCount = 0;
+        int lastHeadLine = -1;
+        int lastTailLine = -1;
+        int currentLstLineRef = -1;
+        int currentErrorNr = -1;
+        QString currentErrText;
+    };
+    struct ParseResult {
+        QStringList logLines;
+        QVector<LogParser::MarkData> marks;
+        QVector<LogParser::ErrorData> errors;
+        QVector<int> headLines;
+        QVector<int> tailLines;
+    };
+
     template<typename T>
     class RingBuffer {
     public:
@@ -90,6 +121,9 @@ public:
     AbstractTextMapper::Kind kind() const override { return AbstractTextMapper::memoryMapper; }
 
     void setLogParser(LogParser *parser);
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+    qint64 memoryUsage() const;
     qint64 size() const override;
     void startRun() override;
     void endRun() override;
@@ -122,20 +156,25 @@ private slots:
     void runFinished();
     void fetchDisplay();
     void processPending();
+    void parseFinished();
 
 private: // methods
     void appendLineData(const QByteArray &data, Chunk *&chunk);
     void appendEmptyLine();
     void clearLastLine();
     void parseNewLine();
-    void fetchLog();
-    void createErrorMarks(LineRef ref, bool readErrorText);
+    void startParsing();
+    void finishParsing();
+    void applyParseResult(const ParseResult &result);
+    static ParseResult parseItems(LogParser *parser, ParseState *state, const QVector<ParseItem> &items);
     LineRef nextRef(const LineRef &ref);
     LineRef prevRef(const LineRef &ref);
     QByteArray lineData(const LineRef &ref);
     Chunk *addChunk(bool startUnit = false);
-    void shrinkLog(qint64 minBytes);
-    bool ensureSpace(qint64 bytes);
+    const QByteArray &chunkData(Chunk *chunk) const;
+    void packChunk(Chunk *chunk) const;
+    bool spillChunk(Chunk *chunk) const;
+    void releaseChunks() const;
     void recalcLineCount();
     LineRef logLineToRef(const int &lineNr);
     Chunk *nextChunk(Chunk *chunk);
@@ -156,17 +195,22 @@ private: // members
     QVector<int> mMarksHead;
     RingBuffer<int> mMarksTail;
     QVector<LineRef> mMarkers;
-    int mShrinkLineCount = 0;
+    qint64 mMemoryBudget = 64*1024*1024;
+    mutable QList<Chunk*> mHotChunks;       // uncompressed chunks, the least recently used first
+    mutable QHash<Chunk*, ColdChunk> mColdChunks;
+    mutable QList<Chunk*> mPackedChunks;    // cold chunks with compressed data in memory, the oldest first
+    mutable qint64 mPackedBytes = 0;
+    mutable QTemporaryFile mSpillFile;
     QTimer mRunFinishedTimer;
-    int mErrCount = 0;
-    int mCurrentLstLineRef = -1;
-    int mCurrentErrorNr = -1;
-    QString mCurrentErrText;
     Pendings mPending;
 
+    QVector<ParseItem> mParseItems;     // collected lines, handed over to the parser in batches
+    ParseState mParseState;             // only accessed by the parser while mParseBusy
+    QFutureWatcher<ParseResult> mParseWatcher;
+    bool mParseBusy = false;
+
     bool mLastLineIsOpen = false;
     int mLastLineLen = 0;
-    QStringList mNewLogLines;
     QTime mDisplayCacheChanged;
     QTimer mPendingTimer;
     int mNewLines = 0;
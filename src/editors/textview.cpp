@@ -114,6 +114,14 @@ bool TextView::loadFile(const QString &fileName, int codecMib, bool initAnchor)
     return true;
 }
 
+bool TextView::followGrowth()
+{
+    if (mTextKind != FileText) return false;
+    if (!static_cast<FileMapper*>(mMapper)->followGrowth()) return false;
+    updateView();
+    return true;
+}
+
 TextView::TextKind TextView::kind() const
 {
     if (mMapper->kind() == AbstractTextMapper::memoryMapper)
@@ -556,6 +564,12 @@ void TextView::setLogParser(LogParser *logParser)
         static_cast<MemoryMapper*>(mMapper)->setLogParser(logParser);
 }
 
+void TextView::setLogMemoryBudget(qint64 bytes)
+{
+    if (qobject_cast<MemoryMapper*>(mMapper))
+        static_cast<MemoryMapper*>(mMapper)->setMemoryBudget(bytes);
+}
+
 void TextView::setDebugMode(bool debug)
 {
     if (mMapper->debugMode() != debug) {
@@ -45,6 +45,7 @@ public:
     ~TextView() override;
 
     bool loadFile(const QString &fileName, int codecMib, bool initAnchor);
+    bool followGrowth();
     TextKind kind() const;
     void prepareRun();
     void endRun();
@@ -65,6 +66,7 @@ public:
     bool findText(QRegularExpression searchRegex, QTextDocument::FindFlags flags, bool &continueFind);
     TextKind textKind() const;
     void setLogParser(LogParser *logParser);
+    void setLogMemoryBudget(qint64 bytes);
     void reset();
     void setDebugMode(bool debug);
     void invalidate();
@@ -145,6 +145,7 @@ void FileMeta::linkDocument(QTextDocument *doc)
 
     if (kind() == FileKind::Gms) {
         mHighlighter = new syntax::SyntaxHighlighter(mDocument);
+        mHighlighter->setThreaded(SettingsLocator::settings()->threadedHighlighting());
         connect(mDocument, &QTextDocument::contentsChange, this, &FileMeta::contentsChange);
         connect(mDocument, &QTextDocument::blockCountChanged, this, &FileMeta::blockCountChanged);
     }
@@ -317,8 +318,10 @@ void FileMeta::addEditor(QWidget *edit)
         connect(aEdit, &AbstractEdit::jumpToNextBookmark, mFileRepo, &FileMetaRepo::jumpToNextBookmark);
 
         CodeEdit* scEdit = ViewHelper::toCodeEdit(edit);
-        if (scEdit && mHighlighter)
+        if (scEdit && mHighlighter) {
             connect(scEdit, &CodeEdit::requestSyntaxKind, mHighlighter, &syntax::SyntaxHighlighter::syntaxKind);
+            connect(scEdit, &CodeEdit::visibleBlocksChanged, mHighlighter, &syntax::SyntaxHighlighter::setVisibleBlocks);
+        }
 
         if (!aEdit->viewport()->hasMouseTracking())
             aEdit->viewport()->setMouseTracking(true);
@@ -384,6 +387,8 @@ void FileMeta::removeEditor(QWidget *edit)
     }
     if (scEdit && mHighlighter) {
         disconnect(scEdit, &CodeEdit::requestSyntaxKind, mHighlighter, &syntax::SyntaxHighlighter::syntaxKind);
+        disconnect(scEdit, &CodeEdit::visibleBlocksChanged, mHighlighter, &syntax::SyntaxHighlighter::setVisibleBlocks);
+        mHighlighter->removeVisibleBlocks(scEdit);
     }
 }
 
@@ -618,6 +623,25 @@ void FileMeta::marksChanged(QSet<int> lines)
 
 void FileMeta::reloadDelayed()
 {
+    // files that only have grown are followed by the TextViews without reloading
+    bool followed = (kind() == FileKind::TxtRO || kind() == FileKind::Lst) && !mEditors.isEmpty();
+    for (QWidget *wid: mEditors) {
+        TextView *tv = ViewHelper::toTextView(wid);
+        if (!followed || !tv || !tv->followGrowth()) {
+            followed = false;
+            break;
+        }
+    }
+    if (followed) {
+        mData = Data(location(), mData.type);
+        if (kind() == FileKind::Lst) {
+            for (QWidget *wid: mEditors) {
+                if (lxiviewer::LxiViewer *lxi = ViewHelper::toLxiViewer(wid))
+                    lxi->loadLxi();
+            }
+        }
+        return;
+    }
     for (QWidget *wid: mEditors) {
         if (TextView *tv = ViewHelper::toTextView(wid)) {
             tv->reset();
@@ -743,7 +767,6 @@ QWidget* FileMeta::createEdit(QTabWidget *tabWidget, ProjectRunGroupNode *runGro
         res = ViewHelper::initEditorType(new reference::ReferenceViewer(location(), mCodec, tabWidget));
     } else if (kind() == FileKind::Log) {
         LogParser *parser = new LogParser(mCodec);
-        connect(parser, &LogParser::hasFile, runGroup, &ProjectRunGroupNode::hasFile);
         connect(parser, &LogParser::setErrorText, runGroup, &ProjectRunGroupNode::setErrorText);
         TextView* tView = ViewHelper::initEditorType(new TextView(TextView::MemoryText, tabWidget), EditorType::log);
         tView->setDebugMode(mFileRepo->debugMode());
@@ -751,6 +774,7 @@ QWidget* FileMeta::createEdit(QTabWidget *tabWidget, ProjectRunGroupNode *runGro
         connect(tView, &TextView::jumpToHRef, runGroup, &ProjectRunGroupNode::jumpToHRef);
         connect(tView, &TextView::createMarks, runGroup, &ProjectRunGroupNode::createMarks);
         tView->setLogParser(parser);
+        tView->setLogMemoryBudget(qint64(SettingsLocator::settings()->logMemoryBudgetMB()) * 1024 * 1024);
         res = tView;
     } else if (kind() == FileKind::TxtRO || kind() == FileKind::Lst) {
         EditorType type = kind() == FileKind::TxtRO ? EditorType::txtRo : EditorType::lxiLst;
@@ -26,6 +26,8 @@
 #include "logger.h"
 #include "settingslocator.h"
 #include "editors/viewhelper.h"
+#include "search/trigramindex.h"
+#include <QDir>
 #include <QFileInfo>
 
 namespace gams {
@@ -81,6 +83,7 @@ void FileMetaRepo::addFileMeta(FileMeta *fileMeta)
     mFiles.insert(fileMeta->id(), fileMeta);
     mFileNames.insert(fileMeta->location(), fileMeta);
     watch(fileMeta);
+    if (mTrigramIndex) mTrigramIndex->update(fileMeta->location());
 }
 
 bool FileMetaRepo::askBigFileEdit() const
@@ -99,6 +102,7 @@ void FileMetaRepo::removeFile(FileMeta *fileMeta)
         mFiles.remove(fileMeta->id());
         mFileNames.remove(fileMeta->location());
         unwatch(fileMeta);
+        if (mTrigramIndex) mTrigramIndex->remove(fileMeta->location());
     }
 }
 
@@ -240,6 +244,23 @@ void FileMetaRepo::updateRenamed(FileMeta *file, QString oldLocation)
 {
     mFileNames.remove(oldLocation);
     mFileNames.insert(file->location(), file);
+    if (mTrigramIndex) {
+        mTrigramIndex->remove(oldLocation);
+        mTrigramIndex->update(file->location());
+    }
+}
+
+search::TrigramIndex *FileMetaRepo::trigramIndex()
+{
+    if (!mSettings || !mSettings->searchIndex()) return nullptr;
+    if (!mTrigramIndex) {
+        // the index is kept for all files known to the studio and is stored in the workspace
+        QString indexFile = QDir(mSettings->defaultWorkspace()).filePath(".gamsstudio/searchindex.gti");
+        mTrigramIndex = new search::TrigramIndex(indexFile, this);
+        for (FileMeta *fm : mFiles)
+            mTrigramIndex->update(fm->location());
+    }
+    return mTrigramIndex;
 }
 
 void FileMetaRepo::openFile(FileMeta *fm, NodeId groupId, bool focus, int codecMib)
@@ -254,6 +275,7 @@ void FileMetaRepo::fileChanged(const QString &path)
     FileMeta *file = fileMeta(path);
     if (!file) return;
     mProjectRepo->fileChanged(file->id());
+    if (mTrigramIndex) mTrigramIndex->update(path);
     QFileInfo fi(path);
     if (!fi.exists()) {
         // deleted: delayed check to ensure it's not just rewritten (or renamed)
@@ -31,6 +31,9 @@ namespace studio {
 
 class TextMarkRepo;
 class ProjectRepo;
+namespace search {
+class TrigramIndex;
+}
 
 class FileMetaRepo : public QObject
 {
@@ -56,6 +59,7 @@ public:
     bool debugMode() const;
     static bool equals(const QFileInfo &fi1, const QFileInfo &fi2);
     void updateRenamed(FileMeta *file, QString oldLocation);
+    search::TrigramIndex *trigramIndex();
 
     bool askBigFileEdit() const;
     void setAskBigFileEdit(bool askBigFileEdit);
@@ -89,6 +93,7 @@ private:
     QStringList mRemoved; // List to be checked once
     QStringList mMissList; // List to be checked periodically
     QTimer mMissCheckTimer;
+    search::TrigramIndex *mTrigramIndex = nullptr;
     bool mAskBigFileEdit = true;
     bool mDebug = false;
 
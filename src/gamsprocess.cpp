@@ -32,6 +32,8 @@ namespace studio {
 GamsProcess::GamsProcess(QObject *parent)
     : AbstractGamsProcess("gams", parent)
 {
+    // the process log handles partial lines and profits from large blocks of data
+    setBatchedOutput(true);
 }
 
 void GamsProcess::execute()
@@ -63,18 +63,11 @@ void ColumnFilterFrame::mouseMoveEvent(QMouseEvent *event)
 
 void ColumnFilterFrame::apply()
 {
-    bool* showUelInColumn =  mSymbol->showUelInColumn().at(mColumn);
+    UelBitmap showUels = mSymbol->showUelInColumn(mColumn);
     std::vector<int>* uelsInColumn = mSymbol->uelsInColumn().at(mColumn);
-    bool checked;
-    std::vector<bool> filterActive = mSymbol->filterActive();
-    filterActive[mColumn] = false;
-    for (size_t idx=0; idx<uelsInColumn->size(); idx++) {
-        checked = mModel->checked()[idx];
-        showUelInColumn[uelsInColumn->at(idx)] = checked;
-        if(!checked)
-            filterActive[mColumn] = true;
-    }
-    mSymbol->setFilterActive(filterActive);
+    for (size_t idx=0; idx<uelsInColumn->size(); idx++)
+        showUels.set(uint(uelsInColumn->at(idx)), mModel->checked()[idx]);
+    mSymbol->setShowUelInColumn(mColumn, showUels);
     mSymbol->filterRows();
     static_cast<QMenu*>(this->parent())->close();
     mSymbol->setFilterHasChanged(true);
@@ -0,0 +1,281 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "columnstore.h"
+#include "logger.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QStandardPaths>
+#include <QStorageInfo>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstring>
+
+namespace gams {
+namespace studio {
+namespace gdxviewer {
+
+static const quint32 CColumnCacheMagic = 0x47534343;     // "GSCC"
+static const quint32 CColumnCacheVersion = 1;
+static const qint64 CColumnCacheMinSize = 32*1024*1024;  // smaller symbols are read fast enough
+static const qint64 CHeaderSize = 4096;                  // the columns start page aligned
+static const qint64 CColumnAlign = 64;
+static const qint64 CCacheBudget = 8LL*1024*1024*1024;   // the least recently used caches are removed beyond this
+static const int CStalePartAge = 24*60*60;               // seconds until an unfinished cache file is left over
+static const char CSourceFile[] = "source";              // the path of the GDX file in each cache directory
+
+static qint64 aligned(qint64 size)
+{
+    return (size + CColumnAlign - 1) / CColumnAlign * CColumnAlign;
+}
+
+ColumnStore::ColumnStore(int recordCount, int keyColumns, int valueColumns)
+    : mRecordCount(recordCount), mKeyColumnCount(keyColumns), mValueColumnCount(valueColumns)
+{}
+
+ColumnStore::~ColumnStore()
+{
+    release();
+}
+
+bool ColumnStore::openCache(const QString &gdxFile, int symbolNr, std::vector<int> &minUel, std::vector<int> &maxUel)
+{
+    release();
+    qint64 dataSize = mKeyColumnCount * keyColumnSize() + mValueColumnCount * valueColumnSize();
+    if (dataSize < CColumnCacheMinSize) return false;
+    mFile.setFileName(cacheFileName(gdxFile, symbolNr));
+    if (mFile.fileName().isEmpty() || mFile.size() != CHeaderSize + dataSize || !mFile.open(QFile::ReadOnly))
+        return false;
+
+    QFileInfo gdxInfo(gdxFile);
+    QDataStream in(&mFile);
+    quint32 magic;
+    quint32 version;
+    qint64 gdxSize;
+    qint64 gdxModified;
+    qint32 storedSymbolNr;
+    qint32 recordCount;
+    qint32 keyColumns;
+    qint32 valueColumns;
+    in >> magic >> version;
+    if (magic != CColumnCacheMagic || version != CColumnCacheVersion) {
+        mFile.close();
+        return false;
+    }
+    in >> gdxSize >> gdxModified >> storedSymbolNr >> recordCount >> keyColumns >> valueColumns;
+    if (in.status() != QDataStream::Ok || gdxSize != gdxInfo.size()
+            || gdxModified != gdxInfo.lastModified().toMSecsSinceEpoch() || storedSymbolNr != symbolNr
+            || recordCount != mRecordCount || keyColumns != mKeyColumnCount || valueColumns != mValueColumnCount) {
+        mFile.close();
+        return false;
+    }
+    std::vector<int> storedMinUel(size_t(mKeyColumnCount));
+    std::vector<int> storedMaxUel(size_t(mKeyColumnCount));
+    for (size_t i = 0; i < storedMinUel.size(); ++i) {
+        qint32 lo;
+        qint32 hi;
+        in >> lo >> hi;
+        storedMinUel[i] = lo;
+        storedMaxUel[i] = hi;
+    }
+    if (in.status() != QDataStream::Ok || !mapFile()) {
+        mFile.close();
+        return false;
+    }
+    minUel = storedMinUel;
+    maxUel = storedMaxUel;
+    // the modification time of a cache file is the time of its last use
+    mFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+void ColumnStore::allocate(const QString &gdxFile, int symbolNr)
+{
+    release();
+    qint64 dataSize = mKeyColumnCount * keyColumnSize() + mValueColumnCount * valueColumnSize();
+    QString fileName = cacheFileName(gdxFile, symbolNr);
+    if (!mCacheFailed && dataSize >= CColumnCacheMinSize && dataSize <= CCacheBudget / 2 && !fileName.isEmpty()
+            && QDir().mkpath(QFileInfo(fileName).path()) && cleanCache(gdxFile, fileName, dataSize)
+            && QStorageInfo(QFileInfo(fileName).path()).bytesAvailable() > 2 * dataSize) {
+        // the columns are written to a file of their own and get the final name when they are complete
+        QFileInfo gdxInfo(gdxFile);
+        mGdxSize = gdxInfo.size();
+        mGdxModified = gdxInfo.lastModified().toMSecsSinceEpoch();
+        mSymbolNr = symbolNr;
+        mCacheFile = fileName;
+        mFile.setFileName(QString("%1.%2-%3.part").arg(fileName).arg(QCoreApplication::applicationPid())
+                          .arg(quintptr(this), 0, 16));
+        if (mFile.open(QFile::ReadWrite | QFile::Truncate) && mFile.resize(CHeaderSize + dataSize) && mapFile())
+            return;
+        DEB() << "Could not create GDX column cache " << mFile.fileName();
+        mFile.remove();
+        mCacheFailed = true;
+    }
+    mKeyData.resize(size_t(mRecordCount) * size_t(mKeyColumnCount));
+    mValueData.resize(size_t(mRecordCount) * size_t(mValueColumnCount));
+    for (int i = 0; i < mKeyColumnCount; ++i)
+        mKeyColumns.push_back(mKeyData.data() + size_t(i) * size_t(mRecordCount));
+    for (int i = 0; i < mValueColumnCount; ++i)
+        mValueColumns.push_back(mValueData.data() + size_t(i) * size_t(mRecordCount));
+}
+
+void ColumnStore::commit(const std::vector<int> &minUel, const std::vector<int> &maxUel)
+{
+    if (!mMap) return;
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out << CColumnCacheMagic << CColumnCacheVersion << mGdxSize << mGdxModified << qint32(mSymbolNr)
+        << qint32(mRecordCount) << qint32(mKeyColumnCount) << qint32(mValueColumnCount);
+    for (int i = 0; i < mKeyColumnCount; ++i)
+        out << qint32(minUel[size_t(i)]) << qint32(maxUel[size_t(i)]);
+    memcpy(mMap, header.constData(), size_t(header.size()));
+    mComplete = true;
+}
+
+void ColumnStore::release()
+{
+    mKeyColumns.clear();
+    mValueColumns.clear();
+    mKeyData = std::vector<uint>();
+    mValueData = std::vector<double>();
+    if (mMap) {
+        mFile.unmap(mMap);
+        mMap = nullptr;
+    }
+    if (!mFile.isOpen()) return;
+    if (!(mFile.openMode() & QFile::WriteOnly)) {
+        mFile.close();
+        return;
+    }
+    // a written cache file gets its final name when it is no longer mapped, an incomplete one is of no further use
+    QString partFile = mFile.fileName();
+    mFile.close();
+    if (mComplete) {
+        QFile::remove(mCacheFile);
+        if (QFile::rename(partFile, mCacheFile)) {
+            mComplete = false;
+            return;
+        }
+        DEB() << "Could not store GDX column cache " << mCacheFile;
+    }
+    QFile::remove(partFile);
+    mComplete = false;
+}
+
+/*
+ * Keeps the cache directory within CCacheBudget. Caches of GDX files that no longer exist are removed, as well as
+ * unfinished cache files left over by crashed sessions. Then the least recently used caches are removed until there is
+ * room for the new one.
+ */
+bool ColumnStore::cleanCache(const QString &gdxFile, const QString &cacheFile, qint64 required)
+{
+    static QMutex mutex; // symbols are loaded in parallel
+    QMutexLocker locker(&mutex);
+    QDir symbolDir = QFileInfo(cacheFile).dir();
+    QFile source(symbolDir.filePath(CSourceFile));
+    if (!source.exists() && source.open(QFile::WriteOnly)) {
+        QTextStream out(&source);
+        out.setCodec("UTF-8");
+        out << QFileInfo(gdxFile).absoluteFilePath();
+    }
+
+    QDir cacheDir = symbolDir;
+    cacheDir.cdUp();
+    QDateTime staleTime = QDateTime::currentDateTime().addSecs(-CStalePartAge);
+    QFileInfoList caches;
+    qint64 total = 0;
+    for (const QFileInfo &dirInfo : cacheDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        QDir dir(dirInfo.filePath());
+        QFile dirSource(dir.filePath(CSourceFile));
+        if (dir != symbolDir && dirSource.open(QFile::ReadOnly)) {
+            QTextStream in(&dirSource);
+            in.setCodec("UTF-8");
+            QString gdxPath = in.readAll();
+            dirSource.close();
+            if (!gdxPath.isEmpty() && !QFileInfo::exists(gdxPath)) {
+                dir.removeRecursively();
+                continue;
+            }
+        }
+        for (const QFileInfo &info : dir.entryInfoList(QStringList() << "*.col" << "*.part", QDir::Files)) {
+            if (info.suffix() == "part" && info.lastModified() < staleTime && QFile::remove(info.filePath()))
+                continue;
+            total += info.size();
+            if (info.suffix() == "col")
+                caches << info;
+        }
+    }
+    std::sort(caches.begin(), caches.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastModified() < b.lastModified();
+    });
+    for (const QFileInfo &info : caches) {
+        if (total + required <= CCacheBudget)
+            break;
+        // a cache that is still mapped can't be removed on Windows, it stays until the next cleanup
+        if (QFile::remove(info.filePath()))
+            total -= info.size();
+    }
+    return total + required <= CCacheBudget;
+}
+
+QString ColumnStore::cacheFileName(const QString &gdxFile, int symbolNr) const
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty()) return QString();
+    QByteArray key = QCryptographicHash::hash(QFileInfo(gdxFile).absoluteFilePath().toUtf8(),
+                                              QCryptographicHash::Sha1).toHex();
+    return QDir::cleanPath(dir + "/gdxcolumns/" + key + "/" + QString::number(symbolNr) + ".col");
+}
+
+qint64 ColumnStore::keyColumnSize() const
+{
+    return aligned(qint64(mRecordCount) * qint64(sizeof(uint)));
+}
+
+qint64 ColumnStore::valueColumnSize() const
+{
+    return aligned(qint64(mRecordCount) * qint64(sizeof(double)));
+}
+
+bool ColumnStore::mapFile()
+{
+    mMap = mFile.map(0, mFile.size());
+    if (!mMap) return false;
+    uchar *data = mMap + CHeaderSize;
+    for (int i = 0; i < mKeyColumnCount; ++i) {
+        mKeyColumns.push_back(reinterpret_cast<uint*>(data));
+        data += keyColumnSize();
+    }
+    for (int i = 0; i < mValueColumnCount; ++i) {
+        mValueColumns.push_back(reinterpret_cast<double*>(data));
+        data += valueColumnSize();
+    }
+    return true;
+}
+
+} // namespace gdxviewer
+} // namespace studio
+} // namespace gams
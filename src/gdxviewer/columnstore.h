@@ -0,0 +1,87 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef COLUMNSTORE_H
+#define COLUMNSTORE_H
+
+#include <QFile>
+#include <vector>
+
+namespace gams {
+namespace studio {
+namespace gdxviewer {
+
+///
+/// class ColumnStore
+/// Holds the records of a GDX symbol column by column: one key column per dimension and one column per value field.
+/// Large symbols are kept in a memory-mapped cache file that is reused as long as the GDX file keeps its size and
+/// modification time, small symbols are kept on the heap. The cache directory is limited in size, the least recently
+/// used caches are removed first.
+///
+class ColumnStore
+{
+public:
+    ColumnStore(int recordCount, int keyColumns, int valueColumns);
+    ~ColumnStore();
+
+    /// Maps the complete cache of the symbol if there is a valid one and restores the UEL ranges of the key columns.
+    bool openCache(const QString &gdxFile, int symbolNr, std::vector<int> &minUel, std::vector<int> &maxUel);
+
+    /// Prepares empty columns to be filled, in a new cache file if the symbol is large enough.
+    void allocate(const QString &gdxFile, int symbolNr);
+
+    /// Marks the filled columns as complete. A cache file gets its final name when the columns are released.
+    void commit(const std::vector<int> &minUel, const std::vector<int> &maxUel);
+
+    void release();
+    bool isMapped() const { return mMap; }
+
+    uint *keys(int keyColumn) const { return mKeyColumns[size_t(keyColumn)]; }
+    double *values(int valueColumn) const { return mValueColumns[size_t(valueColumn)]; }
+
+private:
+    QString cacheFileName(const QString &gdxFile, int symbolNr) const;
+    static bool cleanCache(const QString &gdxFile, const QString &cacheFile, qint64 required);
+    qint64 keyColumnSize() const;
+    qint64 valueColumnSize() const;
+    bool mapFile();
+
+private:
+    int mRecordCount;
+    int mKeyColumnCount;
+    int mValueColumnCount;
+    QFile mFile;
+    uchar *mMap = nullptr;
+    qint64 mGdxSize = 0;
+    qint64 mGdxModified = 0;
+    int mSymbolNr = -1;
+    QString mCacheFile;
+    bool mCacheFailed = false;
+    bool mComplete = false;
+    std::vector<uint> mKeyData;
+    std::vector<double> mValueData;
+    std::vector<uint*> mKeyColumns;
+    std::vector<double*> mValueColumns;
+};
+
+} // namespace gdxviewer
+} // namespace studio
+} // namespace gams
+
+#endif // COLUMNSTORE_H
@@ -19,24 +19,67 @@
  */
 #include "gdxsymbol.h"
 #include "exception.h"
+#include "logger.h"
 #include "gdxsymboltable.h"
 #include "nestedheaderview.h"
+#include "sortengine.h"
 
-#include <QMutex>
 #include <QSet>
+#include <QThread>
+#include <QtConcurrent>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <limits>
 
 namespace gams {
 namespace studio {
 namespace gdxviewer {
 
-GdxSymbol::GdxSymbol(gdxHandle_t gdx, QMutex* gdxMutex, int nr, GdxSymbolTable* gdxSymbolTable, QObject *parent)
-    : QAbstractTableModel(parent), mGdx(gdx), mNr(nr), mGdxMutex(gdxMutex), mGdxSymbolTable(gdxSymbolTable)
+static const int CLoadBatchSize = 100000;   // records read before the views are updated and a pause is possible
+static const int CFilterParallelMin = 100000;   // fewer records are filtered on the calling thread
+static const int CFilterBlockSize = 4096;       // keys looked up in the toggled labels at once
+
+namespace {
+
+struct FilterChunk {
+    int from;
+    int to;
+    int count = 0;
+};
+
+QVector<FilterChunk> filterChunks(int count)
+{
+    int parts = count < CFilterParallelMin ? 1 : qMax(1, QThread::idealThreadCount());
+    QVector<FilterChunk> chunks(parts);
+    for (int i = 0; i < parts; ++i) {
+        chunks[i].from = int(qint64(count) * i / parts);
+        chunks[i].to = int(qint64(count) * (i+1) / parts);
+    }
+    return chunks;
+}
+
+template<typename Func>
+void forEachChunk(QVector<FilterChunk> &chunks, Func func)
+{
+    if (chunks.size() == 1)
+        func(chunks[0]);
+    else
+        QtConcurrent::blockingMap(chunks, func);
+}
+
+} // namespace
+
+GdxSymbol::GdxSymbol(gdxHandle_t gdx, int nr, GdxSymbolTable* gdxSymbolTable, QObject *parent)
+    : QAbstractTableModel(parent), mGdx(gdx), mNr(nr), mGdxSymbolTable(gdxSymbolTable)
 {
     loadMetaData();
     loadDomains();
 
+    int valueColumns = (mType == GMS_DT_EQU || mType == GMS_DT_VAR) ? GMS_VAL_MAX : 1;
+    mColumns = new ColumnStore(mRecordCount, mDim, valueColumns);
+
     mRecSortIdx.resize(mRecordCount);
     for(int i=0; i<mRecordCount; i++)
         mRecSortIdx[i] = i;
@@ -45,9 +88,8 @@ GdxSymbol::GdxSymbol(gdxHandle_t gdx, QMutex* gdxMutex, int nr, GdxSymbolTable*
     for(int i=0; i<mRecordCount; i++)
         mRecFilterIdx[i] = i;
 
-    mFilterActive.resize(mDim);
-    for(int i=0; i<mDim; i++)
-        mFilterActive[i] = false;
+    mValueRanges.resize(size_t(valueColumns));
+    mFilterActive.assign(size_t(mDim + valueColumns), false);
 
     mSpecValSortVal.push_back(5.0E300); // GMS_SV_UNDEF
     mSpecValSortVal.push_back(4.0E300); // GMS_SV_NA
@@ -55,16 +97,18 @@ GdxSymbol::GdxSymbol(gdxHandle_t gdx, QMutex* gdxMutex, int nr, GdxSymbolTable*
     mSpecValSortVal.push_back(-std::numeric_limits<double>::max()); // GMS_SV_MINF
     mSpecValSortVal.push_back(4.94066E-324); // GMS_SV_EPS
     // no entry for acronyms. They are sorted by their internal value (>10.0E300 e.g. 1.35e+303 is the smallest acronym value)
+
+    connect(this, &GdxSymbol::recordsRead, this, &GdxSymbol::appendRecords, Qt::QueuedConnection);
 }
 
 GdxSymbol::~GdxSymbol()
 {
+    stopLoadingData();
+    mLoadFuture.waitForFinished();
+    closeLoader();
+    delete mColumns;
     for(auto v : mUelsInColumn)
         delete v;
-    for(auto a: mShowUelInColumn) {
-        if(a)
-            delete[] a;
-    }
 }
 
 QVariant GdxSymbol::headerData(int section, Qt::Orientation orientation, int role) const
@@ -97,8 +141,10 @@ QVariant GdxSymbol::headerData(int section, Qt::Orientation orientation, int rol
         else if (section >= mDim) {
             if (mType == GMS_DT_SET)
                 description += "<p><span style=\" font-weight:600;\">Sort: </span>Left click sorts the explanatory text in alphabetical order using a stable sort mechanism. Sorting direction can be changed by clicking again.</p>";
-            else
+            else {
                 description += "<p><span style=\" font-weight:600;\">Sort: </span>Left click sorts the numeric values using a stable sort mechanism. Sorting direction can be changed by clicking again.</p>";
+                description += "<p><span style=\" font-weight:600;\">Filter:</span> The value range filter can be opened via right click or by clicking on the filter icon.</p>";
+            }
         }
         description += "<p><span style=\" font-weight:600;\">Rearrange columns: </span>Drag-and-drop can be used for changing the order of columns</p>";
         description += "</body></html>";
@@ -133,13 +179,13 @@ QVariant GdxSymbol::data(const QModelIndex &index, int role) const
     else if (role == Qt::DisplayRole) {
         int row = mRecSortIdx[mRecFilterIdx[index.row()]];
         if (index.column() < mDim)
-            return mGdxSymbolTable->uel2Label(mKeys[row*mDim + index.column()]);
+            return mGdxSymbolTable->uel2Label(key(row, index.column()));
         else {
             double val = 0.0;
             if (mType <= GMS_DT_PAR) // Set, Parameter
-                val = mValues[row];
+                val = value(row);
             else // Variable, Equation
-                val = mValues[row*GMS_DT_MAX + (index.column()-mDim)];
+                val = value(row, index.column()-mDim);
             if (mType == GMS_DT_SET)
                 return mGdxSymbolTable->getElementText((int) val);
             else
@@ -160,101 +206,159 @@ QVariant GdxSymbol::data(const QModelIndex &index, int role) const
 
 void GdxSymbol::loadData()
 {
-    QMutexLocker locker(mGdxMutex);
-    mMinUel.resize(mDim);
-    for(int i=0; i<mDim; i++)
-        mMinUel[i] = INT_MAX;
-    mMaxUel.resize(mDim);
-    for(int i=0; i<mDim; i++)
-        mMaxUel[i] = INT_MIN;
-    if(!mIsLoaded) {
-        beginResetModel();
-        endResetModel();
-
-        if(mKeys.empty())
-            mKeys.resize(mRecordCount*mDim);
-        if(mValues.empty()) {
-            if (mType == GMS_DT_PAR || mType == GMS_DT_SET)
-                mValues.resize(mRecordCount);
-            else  if (mType == GMS_DT_EQU || mType == GMS_DT_VAR)
-                 mValues.resize(mRecordCount*GMS_DT_MAX);
-        }
+    if (mIsLoaded)
+        return;
+    QMutexLocker locker(&mLoadMutex);
+    mStopLoading = false;
+    if (mLoadRunning)
+        return;
+    mLoadRunning = true;
+    locker.unlock();
+    mGdxSymbolTable->touchLoader(this);
+    mLoadFuture = QtConcurrent::run(this, &GdxSymbol::readRecords);
+}
+
+void GdxSymbol::stopLoadingData()
+{
+    QMutexLocker locker(&mLoadMutex);
+    mStopLoading = true;
+}
+
+bool GdxSymbol::closePausedLoader()
+{
+    QMutexLocker locker(&mLoadMutex);
+    if (mLoadRunning || !mLoadGdx)
+        return false;
+    closeLoader();
+    return true;
+}
 
+bool GdxSymbol::openLoader()
+{
+    char msg[GMS_SSSIZE];
+    if (!gdxCreateD(&mLoadGdx, mGdxSymbolTable->systemDirectory().toLatin1(), msg, sizeof(msg))) {
+        DEB() << "Could not load GDX library: " << msg;
+        mLoadGdx = nullptr;
+        return false;
+    }
+    int errNr = 0;
+    gdxOpenRead(mLoadGdx, mGdxSymbolTable->gdxFile().toLocal8Bit(), &errNr);
+    int dummy;
+    if (errNr || !gdxDataReadRawStart(mLoadGdx, mNr, &dummy)) {
+        gdxErrorStr(mLoadGdx, errNr ? errNr : gdxGetLastError(mLoadGdx), msg);
+        DEB() << "Problems reading GDX file: " << msg;
+        closeLoader();
+        return false;
+    }
+    // GDX data can't be read from a position. Only a symbol whose paused handle has been closed by
+    // GdxSymbolTable::touchLoader() passes the records it has read already.
+    int keys[GMS_MAX_INDEX_DIM];
+    double values[GMS_VAL_MAX];
+    for (int i = 0; i < mReadRecCount; ++i)
+        gdxDataReadRaw(mLoadGdx, keys, values, &dummy);
+    return true;
+}
+
+void GdxSymbol::closeLoader()
+{
+    if (!mLoadGdx)
+        return;
+    gdxClose(mLoadGdx);
+    gdxFree(&mLoadGdx);
+    mLoadGdx = nullptr;
+}
+
+void GdxSymbol::readRecords()
+{
+    // The loader reads through a handle of its own, so it neither blocks nor is blocked by other symbols. When loading
+    // is paused the handle stays open at its read position and a later loadData() continues from there.
+    bool readDone = mReadStarted && mReadRecCount == mRecordCount; // finished, not yet published
+    if (!mReadStarted)
+        startReading();
+    if (readDone || (!mLoadGdx && mReadRecCount < mRecordCount && !openLoader())) {
+        QMutexLocker locker(&mLoadMutex);
+        mLoadRunning = false;
+        return;
+    }
+    if (mLoadGdx) {
         int dummy;
         int keys[GMS_MAX_INDEX_DIM];
         double values[GMS_VAL_MAX];
-        if (!gdxDataReadRawStart(mGdx, mNr, &dummy)) {
-            char msg[GMS_SSSIZE];
-            gdxErrorStr(mGdx, gdxGetLastError(mGdx), msg);
-            EXCEPT() << "Problems reading GDX file: " << msg;
-        }
-
-        //skip records that have already been loaded
-        for(int i=0; i<mLoadedRecCount; i++) {
-            gdxDataReadRaw(mGdx, keys, values, &dummy);
-            if(stopLoading) {
-                stopLoading = false;
-                gdxDataReadDone(mGdx);
-                return;
+        uint *keyColumns[GMS_MAX_INDEX_DIM];
+        for (int j = 0; j < mDim; ++j)
+            keyColumns[j] = mColumns->keys(j);
+        double *valueColumns[GMS_VAL_MAX];
+        int valueCount = (mType == GMS_DT_EQU || mType == GMS_DT_VAR) ? GMS_VAL_MAX : 1;
+        for (int v = 0; v < valueCount; ++v)
+            valueColumns[v] = mColumns->values(v);
+
+        while (mReadRecCount < mRecordCount) {
+            int batchEnd = qMin(mRecordCount, mReadRecCount + CLoadBatchSize);
+            for (int i = mReadRecCount; i < batchEnd; ++i) {
+                gdxDataReadRaw(mLoadGdx, keys, values, &dummy);
+                for (int j = 0; j < mDim; ++j) {
+                    int k = keys[j];
+                    keyColumns[j][i] = uint(k);
+                    if (k < mMinUel[size_t(j)]) mMinUel[size_t(j)] = k;
+                    if (k > mMaxUel[size_t(j)]) mMaxUel[size_t(j)] = k;
+                }
+                for (int v = 0; v < valueCount; ++v)
+                    valueColumns[v][i] = values[v];
             }
-        }
+            mReadRecCount = batchEnd;
+            if (mReadRecCount == mRecordCount)
+                break;
+            emit recordsRead(mReadRecCount);
 
-        int updateCount = 1000000;
-        int triggerAutoResizeListViewCount = 1000;
-        int keyOffset;
-        int valOffset;
-        int k;
-        for(int i=mLoadedRecCount; i<mRecordCount; i++) {
-            keyOffset = i*mDim;
-            gdxDataReadRaw(mGdx, keys, values, &dummy);
-
-            for(int j=0; j<mDim; j++) {
-                k = keys[j];
-                mKeys[keyOffset+j] = k;
-                mMinUel[j] = qMin(mMinUel[j], k);
-                mMaxUel[j] = qMax(mMaxUel[j], k);
-            }
-            if (mType == GMS_DT_PAR || mType == GMS_DT_SET)
-                mValues[i] = values[0];
-            else if (mType == GMS_DT_EQU || mType == GMS_DT_VAR) {
-                valOffset = i*GMS_VAL_MAX;
-                for(int vIdx=0; vIdx<GMS_VAL_MAX; vIdx++)
-                    mValues[valOffset+vIdx] =  values[vIdx];
-            }
-            mLoadedRecCount++;
-            if (mLoadedRecCount == triggerAutoResizeListViewCount || mLoadedRecCount == mRecordCount) {
-                beginResetModel();
-                endResetModel();
-                emit triggerListViewAutoResize();
-            }
-            mFilterRecCount = mLoadedRecCount;
-            if(i%updateCount == 0) {
-                beginResetModel();
-                endResetModel();
-            }
-            if(stopLoading) {
-                stopLoading = false;
-                gdxDataReadDone(mGdx);
+            QMutexLocker locker(&mLoadMutex);
+            if (mStopLoading) {
+                mLoadRunning = false;
                 return;
             }
         }
-        gdxDataReadDone(mGdx);
+        closeLoader();
+    }
+    if (!mCached)
+        mColumns->commit(mMinUel, mMaxUel);
+    calcDefaultColumns();
+    calcUelsInColumn();
 
-        beginResetModel();
-        endResetModel();
-        calcDefaultColumns();
-        calcUelsInColumn();
+    QMutexLocker locker(&mLoadMutex);
+    mLoadRunning = false;
+    emit recordsRead(mReadRecCount);
+}
 
+void GdxSymbol::startReading()
+{
+    mReadStarted = true;
+    mCached = mColumns->openCache(mGdxSymbolTable->gdxFile(), mNr, mMinUel, mMaxUel);
+    if (mCached) {
+        mReadRecCount = mRecordCount;
+        return;
+    }
+    mColumns->allocate(mGdxSymbolTable->gdxFile(), mNr);
+    mReadRecCount = 0;
+    mMinUel.assign(size_t(mDim), INT_MAX);
+    mMaxUel.assign(size_t(mDim), INT_MIN);
+}
+
+void GdxSymbol::appendRecords(int readRecCount)
+{
+    if (readRecCount > mLoadedRecCount) {
+        bool firstRecords = mLoadedRecCount == 0;
+        beginInsertRows(QModelIndex(), mLoadedRecCount, readRecCount-1);
+        mLoadedRecCount = readRecCount;
+        mFilterRecCount = mLoadedRecCount;
+        endInsertRows();
+        if (firstRecords || mLoadedRecCount == mRecordCount)
+            emit triggerListViewAutoResize();
+    }
+    if (mLoadedRecCount == mRecordCount && !mIsLoaded) {
         mIsLoaded = true;
         emit loadFinished();
     }
 }
 
-void GdxSymbol::stopLoadingData()
-{
-    stopLoading = true;
-}
-
 void GdxSymbol::calcDefaultColumns()
 {
     if(mType != GMS_DT_VAR && mType != GMS_DT_EQU)
@@ -266,7 +370,7 @@ void GdxSymbol::calcDefaultColumns()
         else if (mType == GMS_DT_EQU)
             defVal = gmsDefRecEqu[mSubType][valColIdx];
         for(int i=0; i<mRecordCount; i++) {
-            if(defVal != mValues[i*GMS_VAL_MAX + valColIdx]) {
+            if(defVal != value(i, valColIdx)) {
                 mDefaultColumn[valColIdx] = false;
                 break;
             }
@@ -275,22 +379,21 @@ void GdxSymbol::calcDefaultColumns()
     }
 }
 
-//TODO(CW): refactoring for better performance
 void GdxSymbol::calcUelsInColumn()
 {
     for(int dim=0; dim<mDim; dim++) {
         std::vector<int>* uels = new std::vector<int>();
-        bool* sawUel = new bool[qMax(mMaxUel[dim]+1,1)] {false}; //TODO(CW): squeeze using mMinUel
+        UelBitmap sawUel(mMinUel[size_t(dim)], mMaxUel[size_t(dim)]);
 
-        int lastUel = -1;
-        int currentUel = - 1;
+        uint lastUel = uint(-1);
+        uint currentUel;
         for(int rec=0; rec<mRecordCount; rec++) {
-            currentUel = mKeys[rec*mDim + dim];
+            currentUel = key(rec, dim);
             if(lastUel != currentUel) {
                 lastUel = currentUel;
-                if(!sawUel[currentUel]) {
-                    sawUel[currentUel] = true;
-                    uels->push_back(currentUel);
+                if(!sawUel.contains(currentUel)) {
+                    sawUel.set(currentUel);
+                    uels->push_back(int(currentUel));
                 }
             }
         }
@@ -332,7 +435,7 @@ void GdxSymbol::loadDomains()
     }
 }
 
-double GdxSymbol::specVal2SortVal(double val)
+double GdxSymbol::specVal2SortVal(double val) const
 {
     if (val == GMS_SV_UNDEF)
         return mSpecValSortVal[GMS_SVIDX_UNDEF];
@@ -412,19 +515,106 @@ std::vector<bool> GdxSymbol::filterActive() const
     return mFilterActive;
 }
 
-void GdxSymbol::setFilterActive(const std::vector<bool> &filterActive)
+bool GdxSymbol::hasColumnFilter(int column) const
+{
+    if (column < mDim)
+        return true;
+    return column < columnCount() && (mType == GMS_DT_PAR || mType == GMS_DT_VAR || mType == GMS_DT_EQU);
+}
+
+const UelBitmap &GdxSymbol::showUelInColumn(int column) const
+{
+    return mShowUelInColumn.at(size_t(column));
+}
+
+/*
+ * mRejectCount holds the number of column filters each record fails. A change of the selection in a single column
+ * only touches the records whose label in that column was toggled, which are found by a (gathering) lookup of the
+ * key column in the bitmap of toggled labels, so the other columns are not rescanned.
+ */
+void GdxSymbol::setShowUelInColumn(int column, const UelBitmap &showUels)
+{
+    UelBitmap toggled = mShowUelInColumn.at(size_t(column)) ^ showUels;
+    mShowUelInColumn[size_t(column)] = showUels;
+    mFilterActive[size_t(column)] = showUels.count() < int(mUelsInColumn.at(size_t(column))->size());
+    if (toggled.isEmpty())
+        return;
+    initRejectCounts();
+    const uint *keys = mColumns->keys(column);
+    QVector<FilterChunk> chunks = filterChunks(mRecordCount);
+    forEachChunk(chunks, [this, keys, &toggled, &showUels](FilterChunk &chunk) {
+        std::vector<int> hits;
+        hits.reserve(CFilterBlockSize);
+        for (int from = chunk.from; from < chunk.to; from += CFilterBlockSize) {
+            hits.clear();
+            toggled.select(keys + from, qMin(CFilterBlockSize, chunk.to - from), from, hits);
+            for (int rec : hits) {
+                if (showUels.contains(keys[rec]))
+                    --mRejectCount[size_t(rec)];
+                else
+                    ++mRejectCount[size_t(rec)];
+            }
+        }
+    });
+}
+
+GdxSymbol::ValueRange GdxSymbol::valueRange(int valCol) const
 {
-    mFilterActive = filterActive;
+    return mValueRanges.at(size_t(valCol));
 }
 
-void GdxSymbol::setShowUelInColumn(const std::vector<bool *> &showUelInColumn)
+void GdxSymbol::setValueRange(int valCol, const GdxSymbol::ValueRange &range)
 {
-    mShowUelInColumn = showUelInColumn;
+    ValueRange old = mValueRanges.at(size_t(valCol));
+    mValueRanges[size_t(valCol)] = range;
+    mFilterActive[size_t(mDim + valCol)] = range.active;
+    if (!old.active && !range.active)
+        return;
+    initRejectCounts();
+    const double *values = mColumns->values(valCol);
+    QVector<FilterChunk> chunks = filterChunks(mRecordCount);
+    forEachChunk(chunks, [this, values, &old, &range](FilterChunk &chunk) {
+        for (int rec = chunk.from; rec < chunk.to; ++rec)
+            mRejectCount[size_t(rec)] += quint8(int(range.rejects(values[rec])) - int(old.rejects(values[rec])));
+    });
 }
 
-std::vector<bool *> GdxSymbol::showUelInColumn() const
+bool GdxSymbol::valueBounds(int valCol, double &min, double &max) const
 {
-    return mShowUelInColumn;
+    min = std::numeric_limits<double>::max();
+    max = -std::numeric_limits<double>::max();
+    const double *values = mColumns->values(valCol);
+    for (int rec = 0; rec < mRecordCount; ++rec) {
+        double val = values[rec];
+        if (val < GMS_SV_UNDEF) {
+            if (val < min) min = val;
+            if (val > max) max = val;
+        }
+    }
+    return min <= max;
+}
+
+bool GdxSymbol::ValueRange::rejects(double val) const
+{
+    if (!active)
+        return false;
+    if (val >= GMS_SV_UNDEF) {
+        if (val == GMS_SV_PINF)
+            return max < std::numeric_limits<double>::max();
+        if (val == GMS_SV_MINF)
+            return min > -std::numeric_limits<double>::max();
+        if (val == GMS_SV_EPS)
+            val = 0.0;
+        else
+            return !showSpecialValues;
+    }
+    return val < min || val > max;
+}
+
+void GdxSymbol::initRejectCounts()
+{
+    if (mRejectCount.empty())
+        mRejectCount.assign(size_t(mRecordCount), 0);
 }
 
 std::vector<std::vector<int> *> GdxSymbol::uelsInColumn() const
@@ -438,11 +628,13 @@ void GdxSymbol::resetSortFilter()
         mRecSortIdx[i] = i;
         mRecFilterIdx[i] = i;
     }
-    for(int dim=0; dim<mDim; dim++) {
-        mFilterActive[dim] = false;
+    for(size_t dim=0; dim<mShowUelInColumn.size(); dim++) {
         for(int uel : *mUelsInColumn.at(dim))
-            mShowUelInColumn.at(dim)[uel] = true;
+            mShowUelInColumn[dim].set(uint(uel));
     }
+    std::fill(mValueRanges.begin(), mValueRanges.end(), ValueRange());
+    std::fill(mFilterActive.begin(), mFilterActive.end(), false);
+    std::vector<quint8>().swap(mRejectCount);
     mFilterRecCount = mLoadedRecCount;
     layoutChanged();
 }
@@ -461,103 +653,87 @@ int GdxSymbol::subType() const
 }
 
 /*
- * Custom sorting algorithm that sorts by column using a stable sorting algorithm (std::stable_sort)
+ * Custom sorting algorithm that sorts by column using a stable sorting algorithm (SortEngine)
  *
  * mRecSortIdx maps a row index in the view to a row index in the data. This way the sorting is implemented
  * without actually changing the order of the data itself but storing a mapping of row indexes
  *
  * mLabelCompIdx is used to map a UEL (int) to a specific number (int) which refelects the lexicographical
- * order of label. This allows for better sorting performance since the compare functions only need to compare int
- * instead of QString
+ * order of label. This allows for better sorting performance since the sort keys are integers instead of QString
  */
 void GdxSymbol::sort(int column, Qt::SortOrder order)
 {
+    SortEngine engine;
+    QHash<int, int> textRanks;
+
     // sort by key column
     if(column<mDim) {
-        std::vector<int> labelCompIdx = mGdxSymbolTable->labelCompIdx();
-        QList<QPair<int, int>> l;
-        uint uel;
-        for(int rec=0; rec<mRecordCount; rec++) {
-            uel = mKeys[mRecSortIdx[rec]*mDim + column];
-            // bad uels are sorted by their internal number separately from normal UELS
-            if (uel >= labelCompIdx.size())
-                l.append(QPair<int, int>(uel, mRecSortIdx[rec]));
-            else
-                l.append(QPair<int, int>(labelCompIdx[uel], mRecSortIdx[rec]));
-        }
-        if(order == Qt::SortOrder::AscendingOrder)
-            std::stable_sort(l.begin(), l.end(), [](QPair<int, int> a, QPair<int, int> b) { return a.first < b.first; });
-        else
-            std::stable_sort(l.begin(), l.end(), [](QPair<int, int> a, QPair<int, int> b) { return a.first > b.first; });
-
-        for(int rec=0; rec< mRecordCount; rec++)
-            mRecSortIdx[rec] = l.at(rec).second;
+        const std::vector<int> &labelCompIdx = mGdxSymbolTable->labelCompIdx();
+        engine.addKey([this, column, &labelCompIdx](int rec) {
+            uint uel = key(rec, column);
+            // bad uels are sorted by their internal number
+            return quint64(uel >= labelCompIdx.size() ? int(uel) : labelCompIdx[uel]);
+        }, order);
     }
 
     //sort set and alias by explanatory text
     else if (mType == GMS_DT_SET || mType == GMS_DT_ALIAS) {
-        QList<QPair<QString, int>> l;
-        for(int rec=0; rec<mRecordCount; rec++)
-            l.append(QPair<QString, int>(mGdxSymbolTable->getElementText(mValues[mRecSortIdx[rec]]), mRecSortIdx[rec]));
-
-        if (order == Qt::SortOrder::AscendingOrder)
-            std::stable_sort(l.begin(), l.end(), [](QPair<QString, int> a, QPair<QString, int> b) { return a.first < b.first; });
-        else
-            std::stable_sort(l.begin(), l.end(), [](QPair<QString, int> a, QPair<QString, int> b) { return a.first > b.first; });
-
-        for(int rec=0; rec< mRecordCount; rec++)
-            mRecSortIdx[rec] = l.at(rec).second;
+        QStringList texts;
+        for(int rec=0; rec<mRecordCount; rec++) {
+            int textNr = int(value(rec));
+            if (!textRanks.contains(textNr)) {
+                textRanks.insert(textNr, texts.size());
+                texts << mGdxSymbolTable->getElementText(textNr);
+            }
+        }
+        std::vector<int> ranks = SortEngine::stringRanks(texts, false);
+        for (auto it = textRanks.begin(); it != textRanks.end(); ++it)
+            it.value() = ranks[size_t(it.value())];
+        engine.addKey([this, &textRanks](int rec) { return quint64(textRanks.value(int(value(rec)))); }, order);
     }
     // sort parameter, variable and equation by value columns
     else {
-        QList<QPair<double, int>> l;
-        double val=0;
-        if (mType == GMS_DT_PAR) {
-            for(int rec=0; rec<mRecordCount; rec++) {
-                val = mValues[mRecSortIdx[rec]];
-                if (val>=GMS_SV_UNDEF)
-                    val = specVal2SortVal(val);
-                l.append(QPair<double, int>(val, mRecSortIdx[rec]));
-            }
-        }
-        else if (mType == GMS_DT_VAR || mType == GMS_DT_EQU) {
-            for(int rec=0; rec<mRecordCount; rec++) {
-                val = mValues[mRecSortIdx[rec]*GMS_VAL_MAX + (column-mDim)];
-                if (val>=GMS_SV_UNDEF)
-                    val = specVal2SortVal(val);
-                l.append(QPair<double, int>(val, mRecSortIdx[rec]));
-            }
-        }
-
-        if (order == Qt::SortOrder::AscendingOrder)
-            std::stable_sort(l.begin(), l.end(), [](QPair<double, int> a, QPair<double, int> b) { return a.first < b.first; });
-        else
-            std::stable_sort(l.begin(), l.end(), [](QPair<double, int> a, QPair<double, int> b) { return a.first > b.first; });
-
-        for (int rec=0; rec< mRecordCount; rec++)
-            mRecSortIdx[rec] = l.at(rec).second;
+        int valCol = column-mDim;
+        engine.addKey([this, valCol](int rec) {
+            double val = value(rec, valCol);
+            if (val>=GMS_SV_UNDEF)
+                val = specVal2SortVal(val);
+            return SortEngine::doubleKey(val);
+        }, order);
     }
+    engine.sort(mRecSortIdx);
     layoutChanged();
     filterRows();
 }
 
+/*
+ * Collects the rows (positions in mRecSortIdx) of all records that pass every column filter. The filter state itself
+ * is kept up to date in mRejectCount by setShowUelInColumn() and setValueRange(), so this is a single parallel pass
+ * over the sorted records: each chunk compacts its rows in place, then the chunks are moved together.
+ */
 void GdxSymbol::filterRows()
 {
-    for (int i=0; i<mRecordCount; i++)
-        mRecFilterIdx[i] = i;
-
-    int removedCount = 0;
-
-    mFilterRecCount = mLoadedRecCount;
-    for(int row=0; row<mRecordCount; row++) {
-        int recIdx = mRecSortIdx[row];
-        mRecFilterIdx[row-removedCount] = row;
-        for(int dim=0; dim<mDim; dim++) {
-            if(!mShowUelInColumn.at(dim)[mKeys[recIdx*mDim + dim]]) { //filter record
-                mFilterRecCount--;
-                removedCount++;
-                break;
+    if (mRejectCount.empty() || std::find(mFilterActive.begin(), mFilterActive.end(), true) == mFilterActive.end()) {
+        std::vector<quint8>().swap(mRejectCount);
+        for (int i=0; i<mLoadedRecCount; i++)
+            mRecFilterIdx[i] = i;
+        mFilterRecCount = mLoadedRecCount;
+    } else {
+        QVector<FilterChunk> chunks = filterChunks(mLoadedRecCount);
+        forEachChunk(chunks, [this](FilterChunk &chunk) {
+            int *out = mRecFilterIdx.data() + chunk.from;
+            for (int row = chunk.from; row < chunk.to; ++row) {
+                *out = row;
+                out += mRejectCount[size_t(mRecSortIdx[size_t(row)])] == 0;
             }
+            chunk.count = int(out - mRecFilterIdx.data()) - chunk.from;
+        });
+        mFilterRecCount = 0;
+        for (const FilterChunk &chunk : chunks) {
+            if (mFilterRecCount != chunk.from)
+                memmove(mRecFilterIdx.data() + mFilterRecCount, mRecFilterIdx.data() + chunk.from,
+                        size_t(chunk.count) * sizeof(int));
+            mFilterRecCount += chunk.count;
         }
     }
     beginResetModel();
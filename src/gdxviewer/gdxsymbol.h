@@ -21,12 +21,14 @@
 #define GAMS_STUDIO_GDXVIEWER_GDXSYMBOLDATATABLEMODEL_H
 
 #include <QAbstractTableModel>
+#include <QFuture>
+#include <QMutex>
 #include <QString>
 #include <QTableView>
 
 #include "gdxcc.h"
-
-class QMutex;
+#include "columnstore.h"
+#include "uelbitmap.h"
 
 namespace gams {
 namespace studio {
@@ -42,8 +44,15 @@ class GdxSymbol : public QAbstractTableModel
     friend class TableViewModel;
 
 public:
-    explicit GdxSymbol(gdxHandle_t gdx, QMutex* gdxMutex, int nr,
-                       GdxSymbolTable* gdxSymbolTable, QObject *parent = nullptr);
+    struct ValueRange {
+        bool active = false;
+        double min = 0.0;
+        double max = 0.0;
+        bool showSpecialValues = true;  // UNDEF, NA and acronyms, which have no position on the number line
+        bool rejects(double val) const;
+    };
+
+    explicit GdxSymbol(gdxHandle_t gdx, int nr, GdxSymbolTable* gdxSymbolTable, QObject *parent = nullptr);
     ~GdxSymbol() override;
 
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
@@ -59,6 +68,7 @@ public:
     bool isLoaded() const;
     void loadData();
     void stopLoadingData();
+    bool closePausedLoader();
     bool isAllDefault(int valColIdx);
     int subType() const;
     void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
@@ -68,10 +78,13 @@ public:
     void resetSortFilter();
     GdxSymbolTable *gdxSymbolTable() const;
     std::vector<std::vector<int> *> uelsInColumn() const;
-    std::vector<bool *> showUelInColumn() const;
-    void setShowUelInColumn(const std::vector<bool *> &showUelInColumn);
+    const UelBitmap &showUelInColumn(int column) const;
+    void setShowUelInColumn(int column, const UelBitmap &showUels);
+    ValueRange valueRange(int valCol) const;
+    void setValueRange(int valCol, const ValueRange &range);
+    bool valueBounds(int valCol, double &min, double &max) const;
+    bool hasColumnFilter(int column) const;
     std::vector<bool> filterActive() const;
-    void setFilterActive(const std::vector<bool> &filterActive);
 
     int tvColDim() const;
 
@@ -83,20 +96,30 @@ public:
 signals:
     void loadFinished();
     void triggerListViewAutoResize();
+    void recordsRead(int readRecCount);
+
+private slots:
+    void appendRecords(int readRecCount);
 
 private:
+    void readRecords();
+    void startReading();
+    bool openLoader();
+    void closeLoader();
     void calcDefaultColumns();
     void calcDefaultColumnsTableView();
     void calcUelsInColumn();
+    void initRejectCounts();
     void loadMetaData();
     void loadDomains();
-    double specVal2SortVal(double val);
+    double specVal2SortVal(double val) const;
     QVariant formatValue(double val) const;
+    inline uint key(int rec, int dim) const;
+    inline double value(int rec, int valCol = 0) const;
 
 private:
     gdxHandle_t mGdx = nullptr;
     int mNr;
-    QMutex* mGdxMutex = nullptr;
     int mDim;
     int mType;
     int mSubType;
@@ -113,10 +136,16 @@ private:
     int mLoadedRecCount = 0;
     int mFilterRecCount = 0;
 
-    bool stopLoading = false;
+    gdxHandle_t mLoadGdx = nullptr;     // the loader's own handle, kept open while loading is paused
+    QFuture<void> mLoadFuture;
+    QMutex mLoadMutex;                  // guards mStopLoading and mLoadRunning
+    bool mStopLoading = false;
+    bool mLoadRunning = false;
+    int mReadRecCount = 0;              // records read by the loader, published to the views by appendRecords()
+    bool mReadStarted = false;
+    bool mCached = false;               // columns were opened from the column cache
 
-    std::vector<uint> mKeys;
-    std::vector<double> mValues;
+    ColumnStore *mColumns = nullptr;
 
     QStringList mDomains;
 
@@ -125,8 +154,10 @@ private:
     std::vector<double> mSpecValSortVal;
 
     std::vector<std::vector<int>*> mUelsInColumn;
-    std::vector<bool*> mShowUelInColumn;
-    std::vector<bool> mFilterActive;
+    std::vector<UelBitmap> mShowUelInColumn;
+    std::vector<ValueRange> mValueRanges;
+    std::vector<bool> mFilterActive;        // the key columns followed by the value columns
+    std::vector<quint8> mRejectCount;       // per record the number of column filters it fails, empty if unfiltered
 
     std::vector<int> mRecSortIdx;
     std::vector<int> mRecFilterIdx;
@@ -139,6 +170,16 @@ private:
     int mMaxPrecision = 15;
 };
 
+uint GdxSymbol::key(int rec, int dim) const
+{
+    return mColumns->keys(dim)[rec];
+}
+
+double GdxSymbol::value(int rec, int valCol) const
+{
+    return mColumns->values(valCol)[rec];
+}
+
 } // namespace gdxviewer
 } // namespace studio
 } // namespace gams
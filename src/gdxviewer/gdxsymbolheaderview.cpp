@@ -31,9 +31,9 @@ namespace gdxviewer {
 GdxSymbolHeaderView::GdxSymbolHeaderView(Qt::Orientation orientation, QWidget *parent)
     : QHeaderView(orientation, parent)
 {
-    mFilterIconWidth.resize(GMS_MAX_INDEX_DIM);
-    mFilterIconX.resize(GMS_MAX_INDEX_DIM);
-    mFilterIconY.resize(GMS_MAX_INDEX_DIM);
+    mFilterIconWidth.resize(GMS_MAX_INDEX_DIM + GMS_VAL_MAX);
+    mFilterIconX.resize(GMS_MAX_INDEX_DIM + GMS_VAL_MAX);
+    mFilterIconY.resize(GMS_MAX_INDEX_DIM + GMS_VAL_MAX);
 }
 
 GdxSymbolHeaderView::~GdxSymbolHeaderView()
@@ -49,7 +49,7 @@ void GdxSymbolHeaderView::paintSection(QPainter *painter, const QRect &rect, int
     QTableView* tv = static_cast<QTableView*>(this->parent());
     GdxSymbol* symbol = static_cast<GdxSymbol*>(tv->model());
 
-    if (logicalIndex < symbol->dim()) {
+    if (symbol->hasColumnFilter(logicalIndex)) {
         QString iconRes;
         if (symbol->filterActive()[logicalIndex])
             iconRes = iconFilterOn;
@@ -86,7 +86,7 @@ bool GdxSymbolHeaderView::pointFilterIconCollision(QPoint p)
     QTableView* tv = static_cast<QTableView*>(this->parent());
     GdxSymbol* symbol = static_cast<GdxSymbol*>(tv->model());
 
-    if (index < symbol->dim()) {
+    if (index >= 0 && symbol->hasColumnFilter(index)) {
         if(p.x() >= mFilterIconX[index] && p.x() <= mFilterIconX[index]+mFilterIconWidth[index] &&
            p.y() >= mFilterIconY[index] && p.y() <= mFilterIconY[index]+mFilterIconWidth[index])
             return true;
@@ -22,17 +22,23 @@
 #include "exception.h"
 
 #include <QMutex>
+#include <QtConcurrent>
 #include <limits>
 
 namespace gams {
 namespace studio {
 namespace gdxviewer {
 
-GdxSymbolTable::GdxSymbolTable(gdxHandle_t gdx, QMutex* gdxMutex, QTextCodec* codec, QObject *parent)
-    : QAbstractTableModel(parent), mGdx(gdx), mGdxMutex(gdxMutex), mCodec(codec)
+static const int CMaxPausedLoaders = 4;     // each loader handle holds a copy of the UEL table of the file
+
+GdxSymbolTable::GdxSymbolTable(gdxHandle_t gdx, QMutex* gdxMutex, QTextCodec* codec, QString gdxFile,
+                               QString systemDirectory, QObject *parent)
+    : QAbstractTableModel(parent), mGdx(gdx), mUelStore(codec), mGdxMutex(gdxMutex), mCodec(codec),
+      mGdxFile(gdxFile), mSystemDirectory(systemDirectory)
 {
     gdxSystemInfo(mGdx, &mSymbolCount, &mUelCount);
     loadUel2Label();
+    mSortIndexFuture = QtConcurrent::run(this, &GdxSymbolTable::createSortIndex);
     loadStringPool();
 
     mHeaderText.append("Entry");
@@ -48,6 +54,7 @@ GdxSymbolTable::GdxSymbolTable(gdxHandle_t gdx, QMutex* gdxMutex, QTextCodec* co
 
 GdxSymbolTable::~GdxSymbolTable()
 {
+    mSortIndexFuture.waitForFinished();
     for(auto gdxSymbol : mGdxSymbols)
         delete gdxSymbol;
 }
@@ -119,23 +126,13 @@ void GdxSymbolTable::loadGDXSymbols()
 {
     QMutexLocker locker(mGdxMutex);
     for(int i=0; i<mSymbolCount+1; i++)
-        mGdxSymbols.append(new GdxSymbol(mGdx, mGdxMutex, i, this));
+        mGdxSymbols.append(new GdxSymbol(mGdx, i, this));
     locker.unlock();
 }
 
 void GdxSymbolTable::createSortIndex()
 {
-    QList<QPair<QString, int>> l;
-    for(int uel=0; uel<=mUelCount; uel++)
-        l.append(QPair<QString, int>(uel2Label(uel), uel));
-    std::sort(l.begin(), l.end(), [](QPair<QString, int> a, QPair<QString, int> b) { return a.first.compare(b.first, Qt::CaseInsensitive)<0; });
-
-    mLabelCompIdx.resize(mUelCount+1);
-    int idx = 0;
-    for (QPair<QString, int> p : l) {
-        mLabelCompIdx[p.second] = idx;
-        idx++;
-    }
+    mLabelCompIdx = mUelStore.sortRanks();
 }
 
 int GdxSymbolTable::symbolCount() const
@@ -160,9 +157,10 @@ void GdxSymbolTable::loadUel2Label()
 {
     char label[GMS_UEL_IDENT_SIZE];
     int map;
+    mUelStore.reserve(mUelCount+1);
     for (int i=0; i<=mUelCount; i++) {
         gdxUMUelGet(mGdx, i, label, &map);
-        mUel2Label.append(mCodec->toUnicode(label));
+        mUelStore.append(label);
     }
 }
 
@@ -184,29 +182,54 @@ void GdxSymbolTable::reportIoError(int errNr, QString message)
     EXCEPT() << "Fatal I/O Error = " << errNr << " when calling " << message;
 }
 
+void GdxSymbolTable::touchLoader(GdxSymbol *symbol)
+{
+    // Every opened GDX handle reads the complete UEL table of the file. A paused symbol keeps its handle to resume at
+    // the read position, but only for the most recently loaded symbols.
+    mLoaderUse.removeOne(symbol);
+    mLoaderUse.prepend(symbol);
+    int paused = 0;
+    for (int i = 1; i < mLoaderUse.size(); ) {
+        GdxSymbol *other = mLoaderUse.at(i);
+        if (other->isLoaded() || (paused >= CMaxPausedLoaders && other->closePausedLoader())) {
+            mLoaderUse.removeAt(i);
+            continue;
+        }
+        ++paused;
+        ++i;
+    }
+}
+
 QTextCodec *GdxSymbolTable::codec() const
 {
     return mCodec;
 }
 
-std::vector<int> GdxSymbolTable::labelCompIdx()
+QString GdxSymbolTable::gdxFile() const
 {
-    if (!mIsSortIndexCreated) {
-        this->createSortIndex();
-        mIsSortIndexCreated = true;
-    }
+    return mGdxFile;
+}
+
+QString GdxSymbolTable::systemDirectory() const
+{
+    return mSystemDirectory;
+}
+
+const std::vector<int> &GdxSymbolTable::labelCompIdx()
+{
+    mSortIndexFuture.waitForFinished();
     return mLabelCompIdx;
 }
 
 QString GdxSymbolTable::uel2Label(int uel)
 {
-    if (uel >= mUel2Label.size()) {
+    if (uel >= mUelStore.count()) {
         char label[GMS_UEL_IDENT_SIZE];
         int map;
         gdxUMUelGet(mGdx, uel, label, &map);
         return mCodec->toUnicode(label);
     }
-    return this->mUel2Label.at(uel);
+    return mUelStore.label(uel);
 }
 
 QList<GdxSymbol *> GdxSymbolTable::gdxSymbols() const
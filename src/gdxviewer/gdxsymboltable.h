@@ -21,9 +21,11 @@
 #define GAMS_STUDIO_GDXVIEWER_GDXSYMBOLTABLEMODEL_H
 
 #include <QAbstractItemModel>
+#include <QFuture>
 #include <QTextCodec>
 
 #include "gdxcc.h"
+#include "uelstore.h"
 
 class QMutex;
 
@@ -38,7 +40,8 @@ class GdxSymbolTable : public QAbstractTableModel
     Q_OBJECT
 
 public:
-    explicit GdxSymbolTable(gdxHandle_t gdx, QMutex* gdxMutex, QTextCodec* codec, QObject *parent = nullptr);
+    explicit GdxSymbolTable(gdxHandle_t gdx, QMutex* gdxMutex, QTextCodec* codec, QString gdxFile,
+                            QString systemDirectory, QObject *parent = nullptr);
     ~GdxSymbolTable() override;
 
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
@@ -47,11 +50,17 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QList<GdxSymbol *> gdxSymbols() const;
     QString uel2Label(int uel);
-    std::vector<int> labelCompIdx();
+    const std::vector<int> &labelCompIdx();
     int symbolCount() const;
     QString getElementText(int textNr);
 
     QTextCodec *codec() const;
+    QString gdxFile() const;
+    QString systemDirectory() const;
+
+    /// Called by a symbol that starts or resumes loading. Each paused symbol keeps its loader handle at the read
+    /// position, the handles of the least recently loaded symbols beyond CMaxPausedLoaders are closed.
+    void touchLoader(GdxSymbol *symbol);
 
 private:
     QStringList mHeaderText;
@@ -66,14 +75,17 @@ private:
     void reportIoError(int errNr, QString message);
 
     QList<GdxSymbol*> mGdxSymbols;
-    QStringList mUel2Label;
+    UelStore mUelStore;
     QStringList mStrPool;
 
     std::vector<int> mLabelCompIdx;
-    bool mIsSortIndexCreated = false;
+    QFuture<void> mSortIndexFuture;   // creates mLabelCompIdx in the background
 
     QMutex* mGdxMutex = nullptr;
     QTextCodec *mCodec;
+    QString mGdxFile;
+    QString mSystemDirectory;
+    QList<GdxSymbol*> mLoaderUse;           // symbols that may hold a loader handle, most recently loaded first
 };
 
 } // namespace gdxviewer
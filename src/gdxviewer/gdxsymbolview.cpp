@@ -22,6 +22,7 @@
 #include "gdxsymbolheaderview.h"
 #include "gdxsymbol.h"
 #include "columnfilter.h"
+#include "valuefilter.h"
 #include "nestedheaderview.h"
 #include "tableviewmodel.h"
 #include "common.h"
@@ -144,9 +145,12 @@ GdxSymbolView::~GdxSymbolView()
 void GdxSymbolView::showColumnFilter(QPoint p)
 {
     int column = ui->tvListView->horizontalHeader()->logicalIndexAt(p);
-    if(mSym->isLoaded() && column>=0 && column<mSym->dim()) {
+    if(mSym->isLoaded() && column>=0 && mSym->hasColumnFilter(column)) {
         QMenu m(this);
-        m.addAction(new ColumnFilter(mSym, column, this));
+        if (column < mSym->dim())
+            m.addAction(new ColumnFilter(mSym, column, this));
+        else
+            m.addAction(new ValueFilter(mSym, column-mSym->dim(), this));
         m.exec(ui->tvListView->mapToGlobal(p));
     }
 }
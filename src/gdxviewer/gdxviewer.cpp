@@ -28,7 +28,6 @@
 #include "editors/sysloglocator.h"
 
 #include <QMutex>
-#include <QtConcurrent>
 #include <QMessageBox>
 #include <QClipboard>
 #include <QSortFilterProxyModel>
@@ -81,7 +80,7 @@ void GdxViewer::updateSelectedSymbol(QItemSelection selected, QItemSelection des
         int selectedIdx = mSymbolTableProxyModel->mapToSource(selected.indexes().at(0)).row();
         if (deselected.indexes().size()>0) {
             GdxSymbol* deselectedSymbol = mGdxSymbolTable->gdxSymbols().at(mSymbolTableProxyModel->mapToSource(deselected.indexes().at(0)).row());
-            QtConcurrent::run(deselectedSymbol, &GdxSymbol::stopLoadingData);
+            deselectedSymbol->stopLoadingData();
         }
 
         if (!reload(mCodec))
@@ -103,7 +102,7 @@ void GdxViewer::updateSelectedSymbol(QItemSelection selected, QItemSelection des
         }
 
         if (!selectedSymbol->isLoaded())
-            QtConcurrent::run(this, &GdxViewer::loadSymbol, selectedSymbol);
+            selectedSymbol->loadData();
 
         ui->splitter->replaceWidget(1, mSymbolViews.at(selectedIdx));
     }
@@ -183,11 +182,6 @@ void GdxViewer::releaseFile()
     free();
 }
 
-void GdxViewer::loadSymbol(GdxSymbol* selectedSymbol)
-{
-    selectedSymbol->loadData();
-}
-
 void GdxViewer::copySelectionToClipboard()
 {
     if (!ui->tvSymbols->model())
@@ -231,7 +225,7 @@ bool GdxViewer::init()
     ui->splitter->widget(0)->hide();
     ui->splitter->widget(1)->hide();
 
-    mGdxSymbolTable = new GdxSymbolTable(mGdx, mGdxMutex, mCodec);
+    mGdxSymbolTable = new GdxSymbolTable(mGdx, mGdxMutex, mCodec, mGdxFile, mSystemDirectory);
     mSymbolViews.resize(mGdxSymbolTable->symbolCount() + 1); // +1 because of the hidden universe symbol
 
     mSymbolTableProxyModel = new QSortFilterProxyModel(this);
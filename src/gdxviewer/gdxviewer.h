@@ -64,7 +64,6 @@ private slots:
     void toggleSearchColumns(bool checked);
 
 private:
-    void loadSymbol(GdxSymbol* selectedSymbol);
     void copySelectionToClipboard();
     bool init();
     void free();
@@ -107,7 +107,7 @@ QVariant TableViewModel::data(const QModelIndex &index, int role) const
         else
             keys = mTvRowHeaders[index.row()] + mTvColHeaders[index.column()];
         if (mTvKeysToValIdx.contains(keys)) {
-            double val = mSym->mValues[size_t(mTvKeysToValIdx[keys])];
+            double val = valueAt(mTvKeysToValIdx[keys]);
             if (mSym->mType == GMS_DT_SET)
                 return mGdxSymbolTable->getElementText(int(val));
             else
@@ -122,6 +122,14 @@ QVariant TableViewModel::data(const QModelIndex &index, int role) const
 }
 
 
+double TableViewModel::valueAt(int valIdx) const
+{
+    // valIdx is rec*GMS_VAL_MAX + value column for variables and equations, the record otherwise
+    if (mSym->mType == GMS_DT_VAR || mSym->mType == GMS_DT_EQU)
+        return mSym->value(valIdx / GMS_VAL_MAX, valIdx % GMS_VAL_MAX);
+    return mSym->value(valIdx);
+}
+
 void TableViewModel::calcDefaultColumnsTableView()
 {
     mDefaultColumnTableView.clear();
@@ -144,7 +152,7 @@ void TableViewModel::calcDefaultColumnsTableView()
                 keys = mTvRowHeaders[row] + mTvColHeaders[col];
             double val = defVal;
             if (mTvKeysToValIdx.contains(keys))
-                val = mSym->mValues[size_t(mTvKeysToValIdx[keys])];
+                val = valueAt(mTvKeysToValIdx[keys]);
 
             // We really need (defVal != val) here - but that leads to compiler-warning
             if(defVal < val || defVal > val) {
@@ -221,14 +229,13 @@ void TableViewModel::initTableView(int nrColDim, QVector<int> dimOrder)
     int r;
     for (int rec=0; rec<mSym->mFilterRecCount; rec++) {
         r = mSym->mRecSortIdx[size_t(mSym->mRecFilterIdx[size_t(rec)])];
-        int keyIdx = r*mSym->mDim;
         QVector<uint> rowHeader;
         QVector<uint> colHeader;
 
         for(int i=0; i<mSym->mDim-mTvColDim; i++)
-            rowHeader.push_back(mSym->mKeys[size_t(keyIdx+mTvDimOrder[i])]);
+            rowHeader.push_back(mSym->key(r, mTvDimOrder[i]));
         for(int i=mSym->mDim-mTvColDim; i<mSym->mDim; i++)
-            colHeader.push_back(mSym->mKeys[size_t(keyIdx+mTvDimOrder[i])]);
+            colHeader.push_back(mSym->key(r, mTvDimOrder[i]));
 
         if (mSym->mType == GMS_DT_VAR || mSym->mType == GMS_DT_EQU) {
             colHeader.push_back(0);
@@ -68,6 +68,7 @@ public slots:
 
 private:
     void calcDefaultColumnsTableView();
+    double valueAt(int valIdx) const;
 
     void calcLabelsInRows();
     QVector<QList<QString>> mlabelsInRows;
@@ -0,0 +1,164 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "uelbitmap.h"
+#include "editors/linescanner.h"
+
+#include <QtAlgorithms>
+#include <algorithm>
+#include <climits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define UELBITMAP_X86
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    define UELBITMAP_AVX2
+#  else
+#    define UELBITMAP_AVX2 __attribute__((target("avx2")))
+#  endif
+#endif
+
+namespace gams {
+namespace studio {
+namespace gdxviewer {
+
+static int selectScalar(const quint32 *words, uint minUel, uint bits, const uint *keys, int count, int shift,
+                        std::vector<int> &hits)
+{
+    int res = 0;
+    for (int i = 0; i < count; ++i) {
+        uint bit = keys[i] - minUel;
+        if (bit < bits && (words[bit >> 5] >> (bit & 31)) & 1) {
+            hits.push_back(i + shift);
+            ++res;
+        }
+    }
+    return res;
+}
+
+#ifdef UELBITMAP_X86
+
+UELBITMAP_AVX2
+static int selectAvx2(const quint32 *words, uint minUel, uint bits, const uint *keys, int count, int shift,
+                      std::vector<int> &hits)
+{
+    int res = 0;
+    int i = 0;
+    const __m256i vMin = _mm256_set1_epi32(int(minUel));
+    const __m256i sign = _mm256_set1_epi32(INT_MIN);    // flips the sign bit for an unsigned compare
+    const __m256i vBits = _mm256_xor_si256(_mm256_set1_epi32(int(bits)), sign);
+    const __m256i bitMask = _mm256_set1_epi32(31);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i zero = _mm256_setzero_si256();
+    for ( ; i + 8 <= count; i += 8) {
+        __m256i bit = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), vMin);
+        __m256i inRange = _mm256_cmpgt_epi32(vBits, _mm256_xor_si256(bit, sign));
+        // keys outside of the range are masked out of the gather and keep a zero word
+        __m256i word = _mm256_mask_i32gather_epi32(zero, reinterpret_cast<const int*>(words),
+                                                   _mm256_srli_epi32(bit, 5), inRange, 4);
+        __m256i hit = _mm256_and_si256(_mm256_srlv_epi32(word, _mm256_and_si256(bit, bitMask)), one);
+        quint32 mask = quint32(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(hit, one))));
+        while (mask) {
+            hits.push_back(i + int(qCountTrailingZeroBits(mask)) + shift);
+            ++res;
+            mask &= mask - 1;
+        }
+    }
+    return res + selectScalar(words, minUel, bits, keys + i, count - i, shift + i, hits);
+}
+
+#endif // UELBITMAP_X86
+
+UelBitmap::UelBitmap(int minUel, int maxUel, bool value)
+    : mMinUel(minUel), mBits(maxUel >= minUel ? uint(maxUel - minUel + 1) : 0)
+{
+    mWords.resize((mBits + 31) / 32);
+    fill(value);
+}
+
+int UelBitmap::minUel() const
+{
+    return mMinUel;
+}
+
+int UelBitmap::maxUel() const
+{
+    return mMinUel + int(mBits) - 1;
+}
+
+void UelBitmap::set(uint uel, bool value)
+{
+    uint bit = uel - uint(mMinUel);
+    Q_ASSERT(bit < mBits);
+    if (value)
+        mWords[bit >> 5] |= quint32(1) << (bit & 31);
+    else
+        mWords[bit >> 5] &= ~(quint32(1) << (bit & 31));
+}
+
+void UelBitmap::fill(bool value)
+{
+    std::fill(mWords.begin(), mWords.end(), value ? ~quint32(0) : 0);
+    if (value && (mBits & 31))  // the bits beyond the range stay zero
+        mWords.back() = (quint32(1) << (mBits & 31)) - 1;
+}
+
+int UelBitmap::count() const
+{
+    int res = 0;
+    for (quint32 word : mWords)
+        res += int(qPopulationCount(word));
+    return res;
+}
+
+bool UelBitmap::isEmpty() const
+{
+    for (quint32 word : mWords) {
+        if (word) return false;
+    }
+    return true;
+}
+
+UelBitmap UelBitmap::operator^(const UelBitmap &other) const
+{
+    Q_ASSERT(mMinUel == other.mMinUel && mBits == other.mBits);
+    UelBitmap res(*this);
+    for (size_t i = 0; i < res.mWords.size(); ++i)
+        res.mWords[i] ^= other.mWords[i];
+    return res;
+}
+
+bool UelBitmap::operator==(const UelBitmap &other) const
+{
+    return mMinUel == other.mMinUel && mBits == other.mBits && mWords == other.mWords;
+}
+
+int UelBitmap::select(const uint *keys, int count, int shift, std::vector<int> &hits) const
+{
+    if (!mBits || count <= 0) return 0;
+#ifdef UELBITMAP_X86
+    if (LineScanner::level() == LineScanner::AVX2)
+        return selectAvx2(mWords.data(), uint(mMinUel), mBits, keys, count, shift, hits);
+#endif
+    return selectScalar(mWords.data(), uint(mMinUel), mBits, keys, count, shift, hits);
+}
+
+} // namespace gdxviewer
+} // namespace studio
+} // namespace gams
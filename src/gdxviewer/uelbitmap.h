@@ -0,0 +1,75 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UELBITMAP_H
+#define UELBITMAP_H
+
+#include <QtGlobal>
+#include <vector>
+
+namespace gams {
+namespace studio {
+namespace gdxviewer {
+
+///
+/// class UelBitmap
+/// A set of UELs stored as one bit per UEL over the range [minUel, maxUel] of a key column. UELs outside of the range
+/// are never contained.
+///
+class UelBitmap
+{
+public:
+    explicit UelBitmap(int minUel = 0, int maxUel = -1, bool value = false);
+
+    int minUel() const;
+    int maxUel() const;
+    inline bool contains(uint uel) const;
+
+    /// Adds or removes a UEL, which needs to be within the range of the bitmap.
+    void set(uint uel, bool value = true);
+    void fill(bool value);
+    int count() const;
+    bool isEmpty() const;
+
+    /// Returns the UELs contained in exactly one of both bitmaps, which need to cover the same range.
+    UelBitmap operator^(const UelBitmap &other) const;
+    bool operator==(const UelBitmap &other) const;
+    bool operator!=(const UelBitmap &other) const { return !(*this == other); }
+
+    /// Appends (index + shift) of each key in keys[0..count) that is contained in the bitmap to hits. Uses AVX2
+    /// gathers if the LineScanner level allows it.
+    int select(const uint *keys, int count, int shift, std::vector<int> &hits) const;
+
+private:
+    int mMinUel;
+    uint mBits;
+    std::vector<quint32> mWords;
+};
+
+bool UelBitmap::contains(uint uel) const
+{
+    uint bit = uel - uint(mMinUel);
+    return bit < mBits && (mWords[bit >> 5] >> (bit & 31)) & 1;
+}
+
+} // namespace gdxviewer
+} // namespace studio
+} // namespace gams
+
+#endif // UELBITMAP_H
@@ -0,0 +1,143 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "uelstore.h"
+#include "sortengine.h"
+
+#include <QHash>
+#include <QTextCodec>
+#include <cstring>
+
+namespace gams {
+namespace studio {
+namespace gdxviewer {
+
+static inline uchar asciiLower(uchar c)
+{
+    return (c >= 'A' && c <= 'Z') ? uchar(c + ('a' - 'A')) : c;
+}
+
+static bool isAscii(const char *data, int len)
+{
+    for (int i = 0; i < len; ++i) {
+        if (uchar(data[i]) >= 0x80) return false;
+    }
+    return true;
+}
+
+static quint64 prefixKey(const char *data, int len)
+{
+    quint64 res = 0;
+    for (int i = 0; i < 8; ++i)
+        res = (res << 8) | (i < len ? asciiLower(uchar(data[i])) : 0u);
+    return res;
+}
+
+static int compareFolded(const char *a, int aLen, const char *b, int bLen)
+{
+    int len = qMin(aLen, bLen);
+    for (int i = 0; i < len; ++i) {
+        uchar ca = asciiLower(uchar(a[i]));
+        uchar cb = asciiLower(uchar(b[i]));
+        if (ca != cb) return ca < cb ? -1 : 1;
+    }
+    return aLen - bLen;
+}
+
+UelStore::UelStore(QTextCodec *codec)
+    : mCodec(codec), mOffsets(1, 0)
+{}
+
+void UelStore::reserve(int count)
+{
+    mOffsets.reserve(size_t(count) + 1);
+    mArena.reserve(size_t(count) * 8);
+}
+
+void UelStore::append(const char *label)
+{
+    mArena.insert(mArena.end(), label, label + strlen(label));
+    mOffsets.push_back(quint32(mArena.size()));
+}
+
+int UelStore::count() const
+{
+    return int(mOffsets.size()) - 1;
+}
+
+QString UelStore::label(int uel) const
+{
+    const char *data = mArena.data() + mOffsets[size_t(uel)];
+    int len = int(mOffsets[size_t(uel)+1] - mOffsets[size_t(uel)]);
+    return mCodec ? mCodec->toUnicode(data, len) : QString::fromUtf8(data, len);
+}
+
+std::vector<int> UelStore::sortRanks() const
+{
+    // Labels of ASCII characters are compared by their bytes with folded case. Other labels are case folded
+    // once and compared by the UTF-8 bytes of the folded label.
+    int n = count();
+    QHash<int, QByteArray> folded;
+    std::vector<quint64> prefix(size_t(n));
+    for (int uel = 0; uel < n; ++uel) {
+        const char *data = mArena.data() + mOffsets[size_t(uel)];
+        int len = int(mOffsets[size_t(uel)+1] - mOffsets[size_t(uel)]);
+        if (!isAscii(data, len)) {
+            const QByteArray &key = folded[uel] = label(uel).toCaseFolded().toUtf8();
+            data = key.constData();
+            len = key.size();
+        }
+        prefix[size_t(uel)] = prefixKey(data, len);
+    }
+    auto key = [this, &folded](int uel, int &len) {
+        if (!folded.isEmpty()) {
+            auto it = folded.constFind(uel);
+            if (it != folded.constEnd()) {
+                len = it.value().size();
+                return it.value().constData();
+            }
+        }
+        len = int(mOffsets[size_t(uel)+1] - mOffsets[size_t(uel)]);
+        return mArena.data() + mOffsets[size_t(uel)];
+    };
+    auto less = [&prefix, &key](int a, int b) {
+        if (prefix[size_t(a)] != prefix[size_t(b)])
+            return prefix[size_t(a)] < prefix[size_t(b)];
+        int aLen;
+        int bLen;
+        const char *aData = key(a, aLen);
+        const char *bData = key(b, bLen);
+        int res = compareFolded(aData, aLen, bData, bLen);
+        return res ? res < 0 : a < b;
+    };
+
+    std::vector<int> order(size_t(n));
+    for (int uel = 0; uel < n; ++uel)
+        order[size_t(uel)] = uel;
+    SortEngine::parallelSort(order, less);
+
+    std::vector<int> ranks(size_t(n));
+    for (int i = 0; i < n; ++i)
+        ranks[size_t(order[size_t(i)])] = i;
+    return ranks;
+}
+
+} // namespace gdxviewer
+} // namespace studio
+} // namespace gams
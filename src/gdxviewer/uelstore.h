@@ -0,0 +1,63 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UELSTORE_H
+#define UELSTORE_H
+
+#include <QString>
+#include <vector>
+
+class QTextCodec;
+
+namespace gams {
+namespace studio {
+namespace gdxviewer {
+
+///
+/// class UelStore
+/// Keeps the labels of the unique elements (UELs) of a GDX file as raw bytes in one contiguous arena. Labels are
+/// decoded only when they are requested.
+///
+class UelStore
+{
+public:
+    explicit UelStore(QTextCodec *codec = nullptr);
+
+    void reserve(int count);
+
+    /// Appends the next label as stored in the GDX file.
+    void append(const char *label);
+    int count() const;
+    QString label(int uel) const;
+
+    /// Returns the position of each UEL in the case insensitive order of the labels. The labels are sorted in
+    /// parallel using a precomputed key of the case folded label.
+    std::vector<int> sortRanks() const;
+
+private:
+    QTextCodec *mCodec;
+    std::vector<char> mArena;
+    std::vector<quint32> mOffsets;  // the start of each label in the arena, followed by the end of the arena
+};
+
+} // namespace gdxviewer
+} // namespace studio
+} // namespace gams
+
+#endif // UELSTORE_H
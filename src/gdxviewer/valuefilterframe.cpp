@@ -0,0 +1,100 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "valuefilterframe.h"
+#include "gdxsymbol.h"
+
+#include <QDoubleValidator>
+#include <QMenu>
+#include <QMouseEvent>
+
+namespace gams {
+namespace studio {
+namespace gdxviewer {
+
+ValueFilterFrame::ValueFilterFrame(GdxSymbol *symbol, int valueColumn, QWidget *parent)
+    : QFrame(parent),
+      mSymbol(symbol),
+      mValueColumn(valueColumn)
+{
+    ui.setupUi(this);
+
+    QDoubleValidator *validator = new QDoubleValidator(this);
+    validator->setLocale(QLocale::c());
+    ui.leMin->setValidator(validator);
+    ui.leMax->setValidator(validator);
+
+    if (!mSymbol->valueBounds(mValueColumn, mMin, mMax))
+        mMin = mMax = 0.0; // there are special values only
+    GdxSymbol::ValueRange range = mSymbol->valueRange(mValueColumn);
+    if (range.active) {
+        ui.leMin->setText(QString::number(range.min, 'g', QLocale::FloatingPointShortest));
+        ui.leMax->setText(QString::number(range.max, 'g', QLocale::FloatingPointShortest));
+        ui.cbShowSpecialValues->setChecked(range.showSpecialValues);
+    } else
+        resetRange();
+
+    connect(ui.pbApply, &QPushButton::clicked, this, &ValueFilterFrame::apply);
+    connect(ui.pbReset, &QPushButton::clicked, this, &ValueFilterFrame::resetRange);
+}
+
+ValueFilterFrame::~ValueFilterFrame()
+{
+}
+
+void ValueFilterFrame::mousePressEvent(QMouseEvent *event)
+{
+    Q_UNUSED(event)
+}
+
+void ValueFilterFrame::mouseMoveEvent(QMouseEvent *event)
+{
+    Q_UNUSED(event)
+}
+
+void ValueFilterFrame::apply()
+{
+    GdxSymbol::ValueRange range;
+    bool ok;
+    range.min = QLocale::c().toDouble(ui.leMin->text(), &ok);
+    if (!ok)
+        range.min = mMin;
+    range.max = QLocale::c().toDouble(ui.leMax->text(), &ok);
+    if (!ok)
+        range.max = mMax;
+    if (range.min > range.max)
+        std::swap(range.min, range.max);
+    range.showSpecialValues = ui.cbShowSpecialValues->isChecked();
+    range.active = range.min > mMin || range.max < mMax || !range.showSpecialValues;
+    mSymbol->setValueRange(mValueColumn, range);
+    mSymbol->filterRows();
+    static_cast<QMenu*>(this->parent())->close();
+    mSymbol->setFilterHasChanged(true);
+}
+
+void ValueFilterFrame::resetRange()
+{
+    ui.leMin->setText(QString::number(mMin, 'g', QLocale::FloatingPointShortest));
+    ui.leMax->setText(QString::number(mMax, 'g', QLocale::FloatingPointShortest));
+    ui.cbShowSpecialValues->setChecked(true);
+}
+
+} // namespace gdxviewer
+} // namespace studio
+} // namespace gams
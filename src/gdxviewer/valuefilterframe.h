@@ -0,0 +1,60 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GAMS_STUDIO_GDXVIEWER_VALUEFILTERFRAME_H
+#define GAMS_STUDIO_GDXVIEWER_VALUEFILTERFRAME_H
+
+#include "ui_valuefilterframe.h"
+
+namespace gams {
+namespace studio {
+namespace gdxviewer {
+
+class GdxSymbol;
+
+class ValueFilterFrame : public QFrame
+{
+    Q_OBJECT
+
+public:
+    explicit ValueFilterFrame(GdxSymbol* symbol, int valueColumn, QWidget *parent = nullptr);
+    ~ValueFilterFrame() override;
+
+protected:
+    //mouse events overwritten to prevent closing of the filter menu if user click on empty spaces regions within the frame
+    void mousePressEvent(QMouseEvent * event) override;
+    void mouseMoveEvent(QMouseEvent * event) override;
+
+private slots:
+    void apply();
+    void resetRange();
+
+private:
+    Ui::ValueFilterFrame ui;
+    GdxSymbol* mSymbol;
+    int mValueColumn;
+    double mMin = 0.0;      // the smallest value in the column, special values excluded
+    double mMax = 0.0;      // the largest value in the column, special values excluded
+};
+
+} // namespace gdxviewer
+} // namespace studio
+} // namespace gams
+
+#endif // GAMS_STUDIO_GDXVIEWER_VALUEFILTERFRAME_H
@@ -205,6 +205,7 @@ MainWindow::MainWindow(QWidget *parent)
     mSearchDialog = new search::SearchDialog(this);
 
     if (mSettings->resetSettingsSwitch()) mSettings->resetSettings();
+    mFileMetaRepo.trigramIndex(); // starts loading the stored search index in the background
 
     // stack help under output
     tabifyDockWidget(ui->dockHelpView, ui->dockProcessLog);
@@ -3033,16 +3034,21 @@ void MainWindow::showResults(search::SearchResultList* results)
 {
     int index = ui->logTabs->indexOf(searchDialog()->resultsView()); // did widget exist before?
 
-    // only update if new results available
-    searchDialog()->setResultsView(new search::ResultsView(results, this));
-    connect(searchDialog()->resultsView(), &search::ResultsView::updateMatchLabel, searchDialog(), &search::SearchDialog::updateNrMatches, Qt::UniqueConnection);
-
     QString nr;
     if (results->size() > MAX_SEARCH_RESULTS-1) nr = QString::number(MAX_SEARCH_RESULTS) + "+";
     else nr = QString::number(results->size());
 
     QString title("Results: " + mSearchDialog->searchTerm() + " (" + nr + ")");
 
+    // the view of a running search only needs a new title
+    if (index != -1 && searchDialog()->resultsView()->resultList() == results) {
+        ui->logTabs->setTabText(index, title);
+        return;
+    }
+
+    searchDialog()->setResultsView(new search::ResultsView(results, this));
+    connect(searchDialog()->resultsView(), &search::ResultsView::updateMatchLabel, searchDialog(), &search::SearchDialog::updateNrMatches, Qt::UniqueConnection);
+
     ui->dockProcessLog->show();
     ui->dockProcessLog->activateWindow();
     ui->dockProcessLog->raise();
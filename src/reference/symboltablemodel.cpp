@@ -18,6 +18,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "symboltablemodel.h"
+#include "sortengine.h"
 
 namespace gams {
 namespace studio {
@@ -205,81 +206,56 @@ void SymbolTableModel::sort(int column, Qt::SortOrder order)
     SortType sortType = getSortTypeOf(column);
     ColumnType colType = getColumnTypeOf(column);
 
-    switch(sortType) {
-    case sortInt: {
-
-        QList<QPair<int, int>> idxList;
-        for(int rec=0; rec<items.size(); rec++) {
-            int idx = static_cast<int>(mSortIdxMap[static_cast<size_t>(rec)]);
-            if (colType == columnId)
-               idxList.append(QPair<int, int>(idx, items.at(idx)->id()) );
-            else if (colType == columnDimension)
-                    idxList.append(QPair<int, int>(idx, items.at(idx)->dimension()) );
-        }
-        if (order == Qt::SortOrder::AscendingOrder)
-           std::stable_sort(idxList.begin(), idxList.end(), [](QPair<int, int> a, QPair<int, int> b) { return a.second < b.second; });
-        else
-           std::stable_sort(idxList.begin(), idxList.end(), [](QPair<int, int> a, QPair<int, int> b) { return a.second > b.second; });
-
-        for(int rec=0; rec<items.size(); rec++) {
-            mSortIdxMap[static_cast<size_t>(rec)] = static_cast<size_t>(idxList.at(rec).first);
-        }
-        filterRows();
-        layoutChanged();
-        emit symbolSelectionToBeUpdated();
-        break;
-    }
-    case sortString: {
-
-        QList<QPair<int, QString>> idxList;
-        if (colType == columnFileLocation) {
-            QStringList fileUsed = mReference->getFileUsed();
-            for(int rec=0; rec<fileUsed.size(); rec++) {
-                idxList.append(QPair<int, QString>(rec, mReference->getFileUsed().at(rec)) );
-            }
-        } else  {
-            for(int rec=0; rec<items.size(); rec++) {
-                int idx = static_cast<int>(mSortIdxMap[static_cast<size_t>(rec)]);
-                if (colType == columnName) {
-                    idxList.append(QPair<int, QString>(idx, items.at(idx)->name()) );
-                } else if (colType == columnText) {
-                          idxList.append(QPair<int, QString>(idx, items.at(idx)->explanatoryText()) );
-                } else if (colType == columnType) {
-                          SymbolDataType::SymbolType type = items.at(idx)->type();
-                          idxList.append(QPair<int, QString>(idx, SymbolDataType::from(type).name()) );
-                } else if (colType == columnDomain) {
-                          QString domainStr = getDomainStr( items.at(idx)->domain() );
-                          idxList.append(QPair<int, QString>(idx, domainStr) );
-                } else  {
-                    idxList.append(QPair<int, QString>(idx, "") );
-                }
-            }
-        }
-        if (order == Qt::SortOrder::AscendingOrder)
-           std::stable_sort(idxList.begin(), idxList.end(), [](QPair<int, QString> a, QPair<int, QString> b) { return (QString::localeAwareCompare(a.second, b.second) < 0); });
-        else
-           std::stable_sort(idxList.begin(), idxList.end(), [](QPair<int, QString> a, QPair<int, QString> b) { return (QString::localeAwareCompare(a.second, b.second) > 0); });
+    if (sortType == sortUnknown)
+        return;
 
-        if (colType == columnFileLocation) {
-            for(int rec=0; rec< mReference->getFileUsed().size(); rec++) {
-                mSortIdxMap[static_cast<size_t>(rec)] = static_cast<size_t>(idxList.at(rec).first);
-            }
-            filterRows();
-            layoutChanged();
-        } else {
-            for(int rec=0; rec<items.size(); rec++) {
-                mSortIdxMap[static_cast<size_t>(rec)] = static_cast<size_t>(idxList.at(rec).first);
+    std::vector<int> idxList;
+    QStringList texts;
+    if (colType == columnFileLocation) {
+        texts = mReference->getFileUsed();
+        for(int rec=0; rec<texts.size(); rec++)
+            idxList.push_back(rec);
+    } else {
+        for(int rec=0; rec<items.size(); rec++)
+            idxList.push_back(static_cast<int>(mSortIdxMap[static_cast<size_t>(rec)]));
+        if (sortType == sortString) {
+            for (SymbolReferenceItem *item : items) {
+                if (colType == columnName)
+                    texts << item->name();
+                else if (colType == columnText)
+                    texts << item->explanatoryText();
+                else if (colType == columnType)
+                    texts << SymbolDataType::from(item->type()).name();
+                else if (colType == columnDomain)
+                    texts << getDomainStr(item->domain());
+                else
+                    texts << "";
             }
-            filterRows();
-            layoutChanged();
-            emit symbolSelectionToBeUpdated();
         }
-        break;
-    }
-    case sortUnknown:  {
-        break;
     }
+
+    SortEngine engine;
+    std::vector<int> ranks;
+    if (sortType == sortInt) {
+        engine.addKey([&items, colType](int idx) {
+            if (colType == columnId)
+                return SortEngine::intKey(items.at(idx)->id());
+            if (colType == columnDimension)
+                return SortEngine::intKey(items.at(idx)->dimension());
+            return SortEngine::intKey(0);
+        }, order);
+    } else {
+        ranks = SortEngine::stringRanks(texts, true);
+        engine.addKey([&ranks](int idx) { return quint64(ranks[static_cast<size_t>(idx)]); }, order);
     }
+    engine.sort(idxList);
+
+    for(size_t rec=0; rec<idxList.size(); rec++)
+        mSortIdxMap[rec] = static_cast<size_t>(idxList[rec]);
+    filterRows();
+    layoutChanged();
+    if (colType != columnFileLocation)
+        emit symbolSelectionToBeUpdated();
 }
 
 QModelIndex SymbolTableModel::index(int row, int column, const QModelIndex &parent) const
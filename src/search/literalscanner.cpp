@@ -0,0 +1,186 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "literalscanner.h"
+#include "editors/linescanner.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define LITERALSCANNER_X86
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    define LITERALSCANNER_AVX2
+#  else
+#    define LITERALSCANNER_AVX2 __attribute__((target("avx2")))
+#  endif
+#endif
+
+namespace gams {
+namespace studio {
+namespace search {
+
+struct Needle {
+    char first;
+    char last;
+    bool foldFirst;     // compare the first byte case-insensitive
+    bool foldLast;
+    int lastOffset;
+};
+
+static inline char foldCase(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c | 0x20) : c;
+}
+
+static inline bool isWordChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// ----- candidate kernels: the next index i with data[i] == first and data[i+lastOffset] == last -----
+
+static int candidateScalar(const char *data, int from, int size, const Needle &nd)
+{
+    int end = size - nd.lastOffset;
+    if (!nd.foldFirst) {
+        const char *pos = data + from;
+        while (pos < data + end && (pos = static_cast<const char*>(memchr(pos, nd.first, size_t(data + end - pos))))) {
+            int i = int(pos - data);
+            if ((nd.foldLast ? foldCase(data[i + nd.lastOffset]) : data[i + nd.lastOffset]) == nd.last) return i;
+            ++pos;
+        }
+        return -1;
+    }
+    for (int i = from; i < end; ++i) {
+        if (foldCase(data[i]) == nd.first
+                && (nd.foldLast ? foldCase(data[i + nd.lastOffset]) : data[i + nd.lastOffset]) == nd.last)
+            return i;
+    }
+    return -1;
+}
+
+#ifdef LITERALSCANNER_X86
+
+static inline __m128i compareSse2(__m128i v, __m128i c, bool fold)
+{
+    // or-ing 0x20 folds ASCII letters, false positives of other characters are rejected by the verification
+    return _mm_cmpeq_epi8(fold ? _mm_or_si128(v, _mm_set1_epi8(0x20)) : v, c);
+}
+
+static int candidateSse2(const char *data, int from, int size, const Needle &nd)
+{
+    int i = from;
+    const __m128i first = _mm_set1_epi8(nd.first);
+    const __m128i last = _mm_set1_epi8(nd.last);
+    for ( ; i + nd.lastOffset + 16 <= size; i += 16) {
+        __m128i vFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i vLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + nd.lastOffset));
+        quint32 mask = quint32(_mm_movemask_epi8(_mm_and_si128(compareSse2(vFirst, first, nd.foldFirst),
+                                                               compareSse2(vLast, last, nd.foldLast))));
+        if (mask) return i + int(qCountTrailingZeroBits(mask));
+    }
+    return candidateScalar(data, i, size, nd);
+}
+
+LITERALSCANNER_AVX2
+static inline __m256i compareAvx2(__m256i v, __m256i c, bool fold)
+{
+    return _mm256_cmpeq_epi8(fold ? _mm256_or_si256(v, _mm256_set1_epi8(0x20)) : v, c);
+}
+
+LITERALSCANNER_AVX2
+static int candidateAvx2(const char *data, int from, int size, const Needle &nd)
+{
+    int i = from;
+    const __m256i first = _mm256_set1_epi8(nd.first);
+    const __m256i last = _mm256_set1_epi8(nd.last);
+    for ( ; i + nd.lastOffset + 32 <= size; i += 32) {
+        __m256i vFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i vLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + nd.lastOffset));
+        quint32 mask = quint32(_mm256_movemask_epi8(_mm256_and_si256(compareAvx2(vFirst, first, nd.foldFirst),
+                                                                     compareAvx2(vLast, last, nd.foldLast))));
+        if (mask) return i + int(qCountTrailingZeroBits(mask));
+    }
+    return candidateSse2(data, i, size, nd);
+}
+
+#endif // LITERALSCANNER_X86
+
+static int candidate(const char *data, int from, int size, const Needle &nd)
+{
+#ifdef LITERALSCANNER_X86
+    switch (LineScanner::level()) {
+    case LineScanner::AVX2: return candidateAvx2(data, from, size, nd);
+    case LineScanner::SSE2: return candidateSse2(data, from, size, nd);
+    default: break;
+    }
+#endif
+    return candidateScalar(data, from, size, nd);
+}
+
+LiteralScanner::LiteralScanner(const QByteArray &literal, bool caseSensitive, bool wholeWord)
+    : mLiteral(literal), mCaseSensitive(caseSensitive), mWholeWord(wholeWord)
+{
+    if (!mCaseSensitive) {
+        for (int i = 0; i < mLiteral.size(); ++i)
+            mLiteral[i] = foldCase(mLiteral.at(i));
+    }
+}
+
+int LiteralScanner::indexIn(const char *data, int from, int size) const
+{
+    if (mLiteral.isEmpty() || from < 0) return -1;
+    const int len = mLiteral.size();
+    Needle nd;
+    nd.first = mLiteral.at(0);
+    nd.last = mLiteral.at(len-1);
+    nd.foldFirst = !mCaseSensitive && nd.first >= 'a' && nd.first <= 'z';
+    nd.foldLast = !mCaseSensitive && nd.last >= 'a' && nd.last <= 'z';
+    nd.lastOffset = len - 1;
+    while (from + len <= size) {
+        int pos = candidate(data, from, size, nd);
+        if (pos < 0) return -1;
+        if (matchesAt(data, pos, size)) return pos;
+        from = pos + 1;
+    }
+    return -1;
+}
+
+bool LiteralScanner::matchesAt(const char *data, int pos, int size) const
+{
+    const int len = mLiteral.size();
+    if (mCaseSensitive) {
+        if (memcmp(data + pos, mLiteral.constData(), size_t(len))) return false;
+    } else {
+        for (int i = 0; i < len; ++i)
+            if (foldCase(data[pos + i]) != mLiteral.at(i)) return false;
+    }
+    if (mWholeWord) {
+        // "\b" matches where a word character borders on a non-word character or on the data bounds
+        bool before = pos > 0 && isWordChar(data[pos-1]);
+        bool after = pos + len < size && isWordChar(data[pos + len]);
+        if (before == isWordChar(mLiteral.at(0)) || after == isWordChar(mLiteral.at(len-1))) return false;
+    }
+    return true;
+}
+
+} // namespace search
+} // namespace studio
+} // namespace gams
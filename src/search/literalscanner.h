@@ -0,0 +1,58 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LITERALSCANNER_H
+#define LITERALSCANNER_H
+
+#include <QByteArray>
+
+namespace gams {
+namespace studio {
+namespace search {
+
+///
+/// class LiteralScanner
+/// Finds a literal byte sequence in raw text data. ASCII letters can be matched case-insensitive and matches can be
+/// restricted to whole words, following the rules of "\b" in QRegularExpression. Candidates are prefiltered by the
+/// first and last byte of the literal using the SIMD level of the LineScanner.
+///
+class LiteralScanner
+{
+public:
+    LiteralScanner(const QByteArray &literal = QByteArray(), bool caseSensitive = true, bool wholeWord = false);
+
+    /// Returns the index of the next match in data[from..size) or -1 if there is none.
+    int indexIn(const char *data, int from, int size) const;
+
+    bool isValid() const { return !mLiteral.isEmpty(); }
+    int length() const { return mLiteral.size(); }
+
+private:
+    bool matchesAt(const char *data, int pos, int size) const;
+
+    QByteArray mLiteral;        // ASCII letters are folded to lower case if not case sensitive
+    bool mCaseSensitive;
+    bool mWholeWord;
+};
+
+} // namespace search
+} // namespace studio
+} // namespace gams
+
+#endif // LITERALSCANNER_H
@@ -0,0 +1,217 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "replaceworker.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QTextCodec>
+#include <QThread>
+#include <QtConcurrent>
+
+namespace gams {
+namespace studio {
+namespace search {
+
+static const int CBlockSize = 1024*1024;        // the size of the blocks read from the file
+
+static QByteArray byteOrderMark(const QByteArray &head, QTextCodec *codec)
+{
+    int mib = codec->mibEnum();
+    QList<QByteArray> boms;
+    if (mib == 106)
+        boms << QByteArray("\xEF\xBB\xBF");
+    else if (mib == 1013 || mib == 1014 || mib == 1015)
+        boms << QByteArray("\xFF\xFE") << QByteArray("\xFE\xFF");
+    else if (mib == 1017 || mib == 1018 || mib == 1019)
+        boms << QByteArray("\xFF\xFE\x00\x00", 4) << QByteArray("\x00\x00\xFE\xFF", 4);
+    for (const QByteArray &bom : boms) {
+        if (head.startsWith(bom)) return bom;
+    }
+    return QByteArray();
+}
+
+static QTextCodec *encodingCodec(QTextCodec *codec, const QByteArray &bom)
+{
+    // the byte order of UTF-16 and UTF-32 is taken from the byte order mark
+    if (bom.isEmpty()) return codec;
+    int mib = codec->mibEnum();
+    if (mib == 1015) return QTextCodec::codecForMib(bom.at(0) == '\xFF' ? 1014 : 1013);
+    if (mib == 1017) return QTextCodec::codecForMib(bom.at(0) == '\xFF' ? 1019 : 1018);
+    return codec;
+}
+
+static bool nextLines(QFile &file, QTextDecoder *decoder, QString &rest, QString &lines)
+{
+    // reads the next complete lines including their line breaks, the remainder is kept in rest
+    forever {
+        QByteArray data = file.read(CBlockSize);
+        if (data.isEmpty()) {
+            lines = rest;
+            rest.clear();
+            return !lines.isEmpty();
+        }
+        rest += decoder->toUnicode(data);
+        int end = rest.length() - 1;
+        if (end >= 0 && rest.at(end) != '\n') {
+            // a CR at the end may be followed by a LF in the next block
+            --end;
+            while (end >= 0 && rest.at(end) != '\n' && rest.at(end) != '\r') --end;
+        }
+        if (end < 0) continue;
+        lines = rest.left(end + 1);
+        rest.remove(0, end + 1);
+        return true;
+    }
+}
+
+static int lineEnd(const QString &text, int pos, int &next)
+{
+    // returns the end of the line starting at pos, next is set to the start of the following line
+    int end = pos;
+    while (end < text.length() && text.at(end) != '\n' && text.at(end) != '\r') ++end;
+    next = end;
+    if (next < text.length())
+        next += (text.at(next) == '\r' && next + 1 < text.length() && text.at(next + 1) == '\n') ? 2 : 1;
+    return end;
+}
+
+static bool containsMatch(QFile &file, QTextCodec *codec, const QRegularExpression &regex, QThread *owner)
+{
+    QScopedPointer<QTextDecoder> decoder(codec->makeDecoder());
+    QString rest;
+    QString lines;
+    while (nextLines(file, decoder.data(), rest, lines)) {
+        if (owner && owner->isInterruptionRequested()) return false;
+        int next = 0;
+        for (int pos = 0; pos < lines.length(); pos = next) {
+            int end = lineEnd(lines, pos, next);
+            if (regex.match(lines.midRef(pos, end - pos)).hasMatch()) return true;
+        }
+    }
+    return false;
+}
+
+ReplaceWorker::ReplaceWorker(QRegularExpression regex, QString replaceTerm, QList<SearchFile> files)
+    : mRegex(regex), mReplaceTerm(replaceTerm), mFiles(files)
+{
+}
+
+void ReplaceWorker::replaceInFiles()
+{
+    QThread *owner = thread();
+    mHits.fill(0, mFiles.size());
+    mNextFile = 0;
+    mFilesDone = 0;
+    mHitCount = 0;
+
+    // each worker takes the next pending file as soon as it is idle
+    QVector<QFuture<void>> workers;
+    int workerCount = qMin(QThread::idealThreadCount(), mFiles.size());
+    for (int i = 0; i < workerCount; ++i)
+        workers << QtConcurrent::run(this, &ReplaceWorker::processFiles, owner);
+    for (QFuture<void> &worker : workers)
+        worker.waitForFinished();
+
+    emit finished(mHits);
+    thread()->quit();
+}
+
+void ReplaceWorker::processFiles(QThread *owner)
+{
+    QRegularExpression regex(mRegex.pattern(), mRegex.patternOptions());
+    int i;
+    while ((i = mNextFile.fetchAndAddOrdered(1)) < mFiles.size()) {
+        // files that are skipped after an interruption stay unchanged
+        if (owner->isInterruptionRequested()) break;
+        int hits = replaceInFile(mFiles.at(i), regex, mReplaceTerm, owner);
+        mHits[i] = hits;
+        if (hits > 0) mHitCount.fetchAndAddOrdered(hits);
+        emit progress(mFilesDone.fetchAndAddOrdered(1) + 1, mHitCount.load());
+    }
+}
+
+int ReplaceWorker::replaceInFile(const SearchFile &file, const QRegularExpression &regex, const QString &replaceTerm,
+                                 QThread *owner)
+{
+    QTextCodec *codec = file.codec ? file.codec : QTextCodec::codecForMib(106);
+    QFile in(file.location);
+    if (!in.open(QFile::ReadOnly)) return -1;
+
+    // a first pass avoids rewriting files without a match
+    if (!containsMatch(in, codec, regex, owner)) return in.error() == QFile::NoError ? 0 : -1;
+    if (!in.seek(0)) return -1;
+
+    // the byte order mark is copied as is, the encoder must not create another one
+    QByteArray bom = byteOrderMark(in.peek(4), codec);
+    QScopedPointer<QTextDecoder> decoder(codec->makeDecoder());
+    QScopedPointer<QTextEncoder> encoder(encodingCodec(codec, bom)->makeEncoder(QTextCodec::IgnoreHeader));
+    QSaveFile out(file.location);
+    if (!out.open(QFile::WriteOnly)) return -1;
+    out.write(bom);
+
+    int hits = 0;
+    QString rest;
+    QString lines;
+    QString replaced;
+    while (nextLines(in, decoder.data(), rest, lines)) {
+        if (owner && owner->isInterruptionRequested()) {
+            out.cancelWriting();
+            return 0;
+        }
+        replaced.clear();
+        int next = 0;
+        for (int pos = 0; pos < lines.length(); pos = next) {
+            int end = lineEnd(lines, pos, next);
+            QStringRef lineRef = lines.midRef(pos, end - pos);
+            if (regex.match(lineRef).hasMatch()) {
+                QString line = lineRef.toString();
+                hits += replace(line, regex, replaceTerm);
+                replaced += line;
+            } else {
+                replaced += lineRef;
+            }
+            replaced += lines.midRef(end, next - end);
+        }
+        out.write(encoder->fromUnicode(replaced));
+    }
+    if (in.error() != QFile::NoError) {
+        out.cancelWriting();
+        return -1;
+    }
+    in.close();
+    return out.commit() ? hits : -1;
+}
+
+int ReplaceWorker::replace(QString &text, const QRegularExpression &regex, const QString &replaceTerm)
+{
+    int count = 0;
+    QRegularExpressionMatchIterator it = regex.globalMatch(text);
+    while (it.hasNext()) {
+        it.next();
+        ++count;
+    }
+    if (count) text.replace(regex, replaceTerm);
+    return count;
+}
+
+}
+}
+}
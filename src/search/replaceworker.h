@@ -0,0 +1,75 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef REPLACEWORKER_H
+#define REPLACEWORKER_H
+
+#include "searchworker.h"
+#include <QObject>
+#include <QRegularExpression>
+#include <QVector>
+
+class QThread;
+
+namespace gams {
+namespace studio {
+namespace search {
+
+///
+/// class ReplaceWorker
+/// Replaces all matches of a regex in files that aren't opened in an editor. The files are processed in parallel,
+/// each one is streamed into a temporary file that replaces the original atomically. The codec, byte order mark and
+/// line endings of each file are kept. Files without a match are left untouched.
+///
+class ReplaceWorker : public QObject
+{
+    Q_OBJECT
+public:
+    ReplaceWorker(QRegularExpression regex, QString replaceTerm, QList<SearchFile> files);
+    void replaceInFiles();
+
+    /// Replaces all matches in the file line by line, returns the count of replacements or -1 on failure.
+    /// An interruption of the owner leaves the file unchanged.
+    static int replaceInFile(const SearchFile &file, const QRegularExpression &regex, const QString &replaceTerm,
+                             QThread *owner = nullptr);
+
+    /// Replaces all matches in the text and returns their count.
+    static int replace(QString &text, const QRegularExpression &regex, const QString &replaceTerm);
+
+signals:
+    void progress(int filesDone, int hits);
+    void finished(const QVector<int> &hits);    // the count of replacements for each file, -1 if it failed
+
+private:
+    void processFiles(QThread *owner);
+
+    QRegularExpression mRegex;
+    QString mReplaceTerm;
+    QList<SearchFile> mFiles;
+    QVector<int> mHits;
+    QAtomicInt mNextFile;
+    QAtomicInt mFilesDone;
+    QAtomicInt mHitCount;
+};
+
+}
+}
+}
+
+#endif // REPLACEWORKER_H
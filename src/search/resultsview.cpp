@@ -29,7 +29,7 @@ namespace studio {
 namespace search {
 
 ResultsView::ResultsView(SearchResultList* resultList, MainWindow *parent) :
-    QWidget(parent), ui(new Ui::ResultsView), mMain(parent), mResultList(resultList->searchRegex())
+    QWidget(parent), ui(new Ui::ResultsView), mMain(parent), mResultList(resultList)
 {
     ui->setupUi(this);
     ui->tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
@@ -37,10 +37,7 @@ ResultsView::ResultsView(SearchResultList* resultList, MainWindow *parent) :
     ui->tableView->verticalHeader()->setDefaultSectionSize(int(fontMetrics().height()*TABLE_ROW_HEIGHT));
     ui->tableView->setTextElideMode(Qt::ElideLeft);
 
-    for (Result r : resultList->resultsAsList()) {
-        mResultList.addResult(r.lineNr(), r.colNr(), r.length(), r.filepath(), r.context());
-    }
-    ui->tableView->setModel(&mResultList);
+    ui->tableView->setModel(mResultList);
 
     QPalette palette;
     palette.setColor(QPalette::Highlight, ui->tableView->palette().highlight().color());
@@ -59,9 +56,14 @@ void ResultsView::resizeColumnsToContent()
     ui->tableView->resizeColumnToContents(1);
 }
 
+SearchResultList *ResultsView::resultList() const
+{
+    return mResultList;
+}
+
 void ResultsView::jumpToResult(int selectedRow, bool focus)
 {
-    Result r = mResultList.at(selectedRow);
+    Result r = mResultList->at(selectedRow);
 
     // open so we have a document of the file
     if (QFileInfo(r.filepath()).exists())
@@ -72,7 +74,7 @@ void ResultsView::jumpToResult(int selectedRow, bool focus)
 
     // jump to line
     node->file()->jumpTo(node->runGroupId(), true, r.lineNr()-1, qMax(r.colNr(), 0), r.length());
-    emit updateMatchLabel(selectedRow+1, mResultList.size());
+    emit updateMatchLabel(selectedRow+1, mResultList->size());
     if (!focus) setFocus();
 }
 
@@ -99,12 +101,12 @@ int ResultsView::selectNextItem(bool backwards)
 {
     int selected = selectedItem();
     int iterator = backwards ? -1 : 1;
-    if (selected == -1) selected = backwards ? mResultList.size() : 0;
+    if (selected == -1) selected = backwards ? mResultList->size() : 0;
 
     int newIndex = selected + iterator;
     if (newIndex < 0)
-        newIndex = mResultList.size()-1;
-    else if (newIndex > mResultList.size()-1)
+        newIndex = mResultList->size()-1;
+    else if (newIndex > mResultList->size()-1)
         newIndex = 0;
 
     selectItem(newIndex);
@@ -47,6 +47,7 @@ public:
     explicit ResultsView(SearchResultList* searchResultList, MainWindow *parent = nullptr);
     ~ResultsView();
     void resizeColumnsToContent();
+    SearchResultList *resultList() const;
 
     void selectItem(int index);
     int selectedItem();
@@ -68,7 +69,7 @@ protected:
 private:
     Ui::ResultsView *ui;
     MainWindow *mMain;
-    SearchResultList mResultList;
+    SearchResultList *mResultList;
     bool mOutdated = false;
 
 private:
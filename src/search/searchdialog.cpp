@@ -25,6 +25,8 @@
 #include "exception.h"
 #include "searchresultlist.h"
 #include "searchworker.h"
+#include "replaceworker.h"
+#include "trigramindex.h"
 #include "option/solveroptionwidget.h"
 #include "settingslocator.h"
 #include "editors/viewhelper.h"
@@ -32,6 +34,7 @@
 #include "../keys.h"
 
 #include <QMessageBox>
+#include <QTextBlock>
 #include <QTextDocumentFragment>
 #include <QThread>
 
@@ -55,16 +58,22 @@ SearchDialog::SearchDialog(MainWindow *parent) :
     ui->lbl_nrResults->setText("");
     ui->combo_search->setAutoCompletion(false);
     adjustSize();
+
+    mUpdateTimer.setInterval(100);
+    connect(&mUpdateTimer, &QTimer::timeout, this, &SearchDialog::intermediateUpdate);
 }
 
 SearchDialog::~SearchDialog()
 {
+    mReplaceThread.requestInterruption();
+    mReplaceThread.wait();
+    releaseCachedResults();
     delete ui;
-    delete mCachedResults;
 }
 
 void SearchDialog::on_btn_Replace_clicked()
 {
+    if (mReplacing) return;
     AbstractEdit* edit = ViewHelper::toAbstractEdit(mMain->recent()->editor());
     if (!edit || edit->isReadOnly()) return;
 
@@ -84,12 +93,18 @@ void SearchDialog::on_btn_Replace_clicked()
 
 void SearchDialog::on_btn_ReplaceAll_clicked()
 {
+    if (mReplacing) {
+        mReplaceAborted = true;
+        mReplaceThread.requestInterruption();
+        return;
+    }
     insertHistory();
     replaceAll();
 }
 
 void SearchDialog::on_btn_FindAll_clicked()
 {
+    if (mReplacing) return;
     if (!mSearching) {
         if (ui->combo_search->currentText().isEmpty()) return;
         mHasChanged = false;
@@ -109,12 +124,34 @@ void SearchDialog::on_btn_FindAll_clicked()
 
 void SearchDialog::intermediateUpdate()
 {
-    setSearchStatus(SearchStatus::Searching);
+    if (!mCachedResults) return;
+    mCachedResults->fetchQueuedResults();
+
+    // the first matches can be used while the search continues
+    if (mShowResults && mCachedResults->size())
+        mMain->showResults(mCachedResults);
+
+    qint64 ms = qMax(qint64(1), mSearchTime.elapsed());
+    ui->lbl_nrResults->setAlignment(Qt::AlignCenter);
+    ui->lbl_nrResults->setText(QString("Searching... %1/%2 files, %3 MB, %4 matches/s")
+                               .arg(mFilesDone).arg(mFileCount)
+                               .arg(QString::number(double(mBytesScanned) / 1024 / 1024, 'f', 1))
+                               .arg(qint64(mCachedResults->resultCount()) * 1000 / ms));
+    ui->lbl_nrResults->setFrameShape(QFrame::StyledPanel);
+}
+
+void SearchDialog::updateProgress(int filesDone, qint64 bytesScanned)
+{
+    mFilesDone = filesDone;
+    mBytesScanned = bytesScanned;
 }
 
 void SearchDialog::finalUpdate()
 {
     setSearchOngoing(false);
+    mUpdateTimer.stop();
+    if (!mCachedResults) return;
+    mCachedResults->fetchQueuedResults();
 
     if (mShowResults) {
         mMain->showResults(mCachedResults);
@@ -150,9 +187,13 @@ void SearchDialog::setSearchOngoing(bool searching)
 ///
 void SearchDialog::findInFiles(SearchResultList* collection, QList<FileMeta*> fml)
 {
-    QList<FileMeta*> unmodified;
+    QList<SearchFile> unmodified;
     QList<FileMeta*> modified; // need to be treated differently
 
+    // files that lack a trigram of the search term can't contain a match
+    TrigramIndex *index = mMain->fileRepo()->trigramIndex();
+    QVector<quint32> trigrams = index ? TrigramIndex::trigrams(createRegex()) : QVector<quint32>();
+
     for(FileMeta* fm : fml) {
 
         // skip certain file types
@@ -161,7 +202,9 @@ void SearchDialog::findInFiles(SearchResultList* collection, QList<FileMeta*> fm
 
         // sort files by modified
         if (fm->isModified()) modified << fm;
-        else unmodified << fm;
+        else if (trigrams.isEmpty() || !SearchWorker::isSplittable(fm->codec())
+                 || index->mayContain(fm->location(), trigrams))
+            unmodified << SearchFile(fm->location(), fm->codec());
     }
 
     // non-parallel first
@@ -173,9 +216,14 @@ void SearchDialog::findInFiles(SearchResultList* collection, QList<FileMeta*> fm
 
     connect(&mThread, &QThread::finished, sw, &QObject::deleteLater, Qt::UniqueConnection);
     connect(this, &SearchDialog::startSearch, sw, &SearchWorker::findInFiles, Qt::UniqueConnection);
-    connect(sw, &SearchWorker::update, this, &SearchDialog::intermediateUpdate, Qt::UniqueConnection);
+    connect(sw, &SearchWorker::progress, this, &SearchDialog::updateProgress, Qt::UniqueConnection);
     connect(sw, &SearchWorker::resultReady, this, &SearchDialog::finalUpdate, Qt::UniqueConnection);
 
+    mFileCount = unmodified.size();
+    mFilesDone = 0;
+    mBytesScanned = 0;
+    mSearchTime.start();
+    mUpdateTimer.start();
     mThread.start();
     emit startSearch();
 }
@@ -296,11 +344,10 @@ void SearchDialog::replaceAll()
         msgBox.setDetailedText(detailedText);
     }
     QPushButton *ok = msgBox.addButton(QMessageBox::Ok);
-    QPushButton *cancel = msgBox.addButton(QMessageBox::Cancel);
+    msgBox.addButton(QMessageBox::Cancel);
     QPushButton *search = msgBox.addButton("Search", QMessageBox::RejectRole);
     msgBox.setDefaultButton(search);
 
-    int hits = 0;
     msgBox.exec();
     if (msgBox.clickedButton() == ok) {
 
@@ -308,88 +355,139 @@ void SearchDialog::replaceAll()
         QApplication::processEvents(QEventLoop::AllEvents, 10); // to show change in UI
 
         QRegularExpression regex = createRegex();
-        QFlags<QTextDocument::FindFlag> flags = setFlags(SearchDirection::Forward);
+        mReplaceHits = 0;
+        mReplaceDetails.clear();
+        mReplaceSearchTerm = searchTerm;
+        mReplaceTerm = replaceTerm;
 
-        for (FileMeta* fm : opened) {
-            hits += replaceOpened(fm, regex, replaceTerm, flags);
-        }
+        for (FileMeta* fm : opened)
+            addReplaceHits(fm->location(), replaceOpened(fm, regex, replaceTerm));
 
-        for (FileMeta* fm : unopened) {
-            hits += replaceUnopened(fm, regex, replaceTerm);
+        // unopened files are rewritten in the background, the summary is shown when they are done
+        if (!unopened.isEmpty()) {
+            replaceUnopened(unopened, regex, replaceTerm);
+            return;
         }
-
-        setSearchStatus(SearchStatus::Clear);
+        replaceFinished(QVector<int>());
     } else if (msgBox.clickedButton() == search) {
         mShowResults = true;
         invalidateCache();
         mCachedResults = new SearchResultList(createRegex());
         findInFiles(mCachedResults, fml);
         return;
-    } else if (msgBox.clickedButton() == cancel) {
-        return;
     }
+}
+
+void SearchDialog::replaceFinished(const QVector<int> &hits)
+{
+    int failed = 0;
+    for (int i = 0; i < hits.size() && i < mReplaceFiles.size(); ++i) {
+        if (hits.at(i) < 0) ++failed;
+        addReplaceHits(mReplaceFiles.at(i), hits.at(i));
+    }
+    mReplaceFiles.clear();
+    setReplaceOngoing(false);
+    setSearchStatus(SearchStatus::Clear);
 
     QMessageBox ansBox;
-    ansBox.setText(QString::number(hits) + " occurrences of '" + searchTerm + "' were replaced with '" + replaceTerm + "'.");
+    QString text = QString::number(mReplaceHits) + " occurrences of '" + mReplaceSearchTerm + "' were replaced with '"
+            + mReplaceTerm + "'.";
+    if (mReplaceAborted) text += " Replacing has been aborted, the remaining files are unchanged.";
+    ansBox.setText(text);
+    if (failed) ansBox.setInformativeText(QString::number(failed) + " files could not be changed.");
+    if (!mReplaceDetails.isEmpty()) ansBox.setDetailedText(mReplaceDetails.join("\n"));
     ansBox.addButton(QMessageBox::Ok);
     ansBox.exec();
 
     invalidateCache();
 }
 
+void SearchDialog::updateReplaceProgress(int filesDone, int hits)
+{
+    ui->lbl_nrResults->setAlignment(Qt::AlignCenter);
+    ui->lbl_nrResults->setText(QString("Replacing... %1/%2 files, %3 replaced")
+                               .arg(filesDone).arg(mReplaceFiles.size()).arg(mReplaceHits + hits));
+    ui->lbl_nrResults->setFrameShape(QFrame::StyledPanel);
+}
+
+void SearchDialog::addReplaceHits(const QString &location, int hits)
+{
+    if (hits > 0) {
+        mReplaceHits += hits;
+        mReplaceDetails << location + ": " + QString::number(hits);
+    } else if (hits < 0) {
+        mReplaceDetails << location + ": failed";
+    }
+}
+
+void SearchDialog::setReplaceOngoing(bool replacing)
+{
+    mReplacing = replacing;
+    if (replacing) mReplaceAborted = false;
+
+    if (replacing)
+        ui->btn_ReplaceAll->setText("Abort");
+    else
+        ui->btn_ReplaceAll->setText("Replace All");
+    updateReplaceActionAvailability();
+}
+
 ///
-/// \brief SearchDialog::replaceUnopened replaces in files where there is currently no editor open
-/// \param fm file
+/// \brief SearchDialog::replaceUnopened replaces in files where there is currently no editor open. The files
+/// are rewritten in parallel by a ReplaceWorker, replaceFinished is called when it is done.
+/// \param fml files
 /// \param regex find
 /// \param replaceTerm replace with
 ///
-int SearchDialog::replaceUnopened(FileMeta* fm, QRegularExpression regex, QString replaceTerm)
+void SearchDialog::replaceUnopened(QList<FileMeta*> fml, QRegularExpression regex, QString replaceTerm)
 {
-    QFile file(fm->location());
-    QTextStream ts(&file);
-    ts.setCodec(fm->codec());
-    int hits = 0;
+    QList<SearchFile> files;
+    for (FileMeta* fm : fml) {
+        files << SearchFile(fm->location(), fm->codec());
+        mReplaceFiles << fm->location();
+    }
 
-    if (file.open(QIODevice::ReadWrite)) {
-        QString content = ts.readAll();
-        hits = content.count(regex);
-        content.replace(regex, replaceTerm);
+    ReplaceWorker* rw = new ReplaceWorker(regex, replaceTerm, files);
+    rw->moveToThread(&mReplaceThread);
 
-        ts.seek(0);
-        ts << content;
-    }
-    file.close();
-    return hits;
+    connect(&mReplaceThread, &QThread::finished, rw, &QObject::deleteLater);
+    connect(this, &SearchDialog::startReplace, rw, &ReplaceWorker::replaceInFiles);
+    connect(rw, &ReplaceWorker::progress, this, &SearchDialog::updateReplaceProgress);
+    connect(rw, &ReplaceWorker::finished, this, &SearchDialog::replaceFinished);
+
+    setReplaceOngoing(true);
+    mReplaceThread.start();
+    emit startReplace();
 }
 
 ///
 /// \brief SearchDialog::replaceOpened uses QTextDocument for replacing strings. this allows the user
-/// to undo changes made by replacing.
+/// to undo changes made by replacing. All replacements of the file are a single edit block. Unlike in unopened
+/// files the replace term is inserted literally.
 /// \param fm filemeta
 /// \param regex find
 /// \param replaceTerm replace with
-/// \param flags options
 ///
-int SearchDialog::replaceOpened(FileMeta* fm, QRegularExpression regex, QString replaceTerm, QFlags<QTextDocument::FindFlag> flags)
+int SearchDialog::replaceOpened(FileMeta* fm, QRegularExpression regex, QString replaceTerm)
 {
-    QTextCursor item;
-    QTextCursor lastItem;
+    QTextDocument *doc = fm->document();
+    QTextCursor tc(doc);
     int hits = 0;
 
-    QTextCursor tc;
-    if (fm->editors().size() > 0)
-        tc = ViewHelper::toAbstractEdit(fm->editors().first())->textCursor();
-
     tc.beginEditBlock();
-    do {
-        item = fm->document()->find(regex, lastItem, flags);
-        lastItem = item;
-
-        if (!item.isNull()) {
-            item.insertText(replaceTerm);
-            hits++;
+    for (QTextBlock block = doc->firstBlock(); block.isValid(); block = block.next()) {
+        QVector<QRegularExpressionMatch> matches;
+        QRegularExpressionMatchIterator it = regex.globalMatch(block.text());
+        while (it.hasNext())
+            matches << it.next();
+        // from back to front, so the earlier matches keep their position
+        for (int i = matches.size() - 1; i >= 0; --i) {
+            tc.setPosition(block.position() + matches.at(i).capturedStart());
+            tc.setPosition(block.position() + matches.at(i).capturedEnd(), QTextCursor::KeepAnchor);
+            tc.insertText(replaceTerm);
         }
-    } while(!item.isNull());
+        hits += matches.size();
+    }
     tc.endEditBlock();
 
     return hits;
@@ -399,7 +497,7 @@ void SearchDialog::updateSearchCache(bool ignoreReadOnly)
 {
     QApplication::sendPostedEvents();
 
-    if (mCachedResults) delete mCachedResults;
+    releaseCachedResults();
     mCachedResults = new SearchResultList(createRegex());
 
     mShowResults = false;
@@ -409,11 +507,11 @@ void SearchDialog::updateSearchCache(bool ignoreReadOnly)
 
 void SearchDialog::findNext(SearchDirection direction, bool ignoreReadOnly)
 {
-    if (ui->combo_search->currentText() == "") return;
+    if (mReplacing || ui->combo_search->currentText() == "") return;
 
     // create new cache when cached search does not contain results for current file. user probably changed tab and a new search needs to start
     bool requestNewCache = mCachedResults &&
-            mCachedResults->filteredResultList(mMain->fileRepo()->fileMeta(mMain->recent()->editor())->location()).size() == 0;
+            mCachedResults->fileRows(mMain->fileRepo()->fileMeta(mMain->recent()->editor())->location()).isEmpty();
 
     if (!mCachedResults || mHasChanged || requestNewCache) {
         invalidateCache();
@@ -447,15 +545,14 @@ void SearchDialog::selectNextMatch(SearchDirection direction)
         colNr = t->position().x();
     }
 
-    QList<Result> resultList = mCachedResults->resultsAsList();
-    if (resultList.size() == 0) {
+    SearchResultList* resultList = mCachedResults;
+    if (resultList->size() == 0) {
         setSearchStatus(SearchStatus::NoResults);
         return;
     }
 
-    const Result* res = nullptr;
     int iterator = backwards ? -1 : 1;
-    int start = backwards ? resultList.size()-1 : 0;
+    int start = backwards ? resultList->size()-1 : 0;
     bool allowJumping = false;
     int matchNr = -1;
 
@@ -464,56 +561,53 @@ void SearchDialog::selectNextMatch(SearchDirection direction)
         int selected = resultsView() ? resultsView()->selectedItem() : -1;
 
         // no rows selected, select new depending on direction
-        if (selected == -1) selected = backwards ? resultList.size() : 0;
+        if (selected == -1) selected = backwards ? resultList->size() : 0;
 
         int newIndex = selected + iterator;
         if (newIndex < 0)
-            newIndex = resultList.size()-1;
-        else if (newIndex > resultList.size()-1)
+            newIndex = resultList->size()-1;
+        else if (newIndex > resultList->size()-1)
             newIndex = 0;
 
-        res = &resultList.at(newIndex);
         matchNr = newIndex;
 
     } else if (mMain->recent()->editor()){
         QString file = ViewHelper::location(mMain->recent()->editor());
-        for (int i = start; i >= 0 && i < resultList.size(); i += iterator) {
-            matchNr = i;
-            Result r = resultList.at(i);
+        int found = -1;
+        for (int i = start; i >= 0 && i < resultList->size(); i += iterator) {
+            Result r = resultList->at(i);
 
             // check if is in same line but behind the cursor
             if (file == r.filepath()) {
                 allowJumping = true;
                 if (backwards) {
                     if (lineNr > r.lineNr() || (lineNr == r.lineNr() && colNr > r.colNr() + r.length())) {
-                        res = &r;
+                        found = i;
                         break;
                     }
                 } else {
                     if (lineNr < r.lineNr() || (lineNr == r.lineNr() && colNr <= r.colNr())) {
-                        res = &r;
+                        found = i;
                         break;
                     }
                 }
             } else if (file != r.filepath() && allowJumping) {
                 // first match in next file
-                res = &r;
+                found = i;
                 break;
             }
         }
+        matchNr = found;
     }
 
-    if (!res) {
-        if (backwards) res = &resultList.last();
-        else res = &resultList.first();
-
-        matchNr = resultList.indexOf(*res);
-    }
+    if (matchNr < 0)
+        matchNr = backwards ? resultList->size()-1 : 0;
+    Result res = resultList->at(matchNr);
 
     // jump to
-    ProjectFileNode *node = mMain->projectRepo()->findFile(res->filepath());
-    if (!node) EXCEPT() << "File not found: " << res->filepath();
-    node->file()->jumpTo(node->runGroupId(), true, res->lineNr()-1, qMax(res->colNr(), 0), res->length());
+    ProjectFileNode *node = mMain->projectRepo()->findFile(res.filepath());
+    if (!node) EXCEPT() << "File not found: " << res.filepath();
+    node->file()->jumpTo(node->runGroupId(), true, res.lineNr()-1, qMax(res.colNr(), 0), res.length());
 
     // update ui
     if (resultsView() && !resultsView()->isOutdated()) resultsView()->selectItem(matchNr);
@@ -645,13 +739,12 @@ void SearchDialog::updateFindNextLabel(int lineNr, int colNr)
         colNr = tc.columnNumber();
     }
 
-    // find match by cursor position
-    QList<Result> list = mCachedResults->resultsAsList();
-    for (int i = 0; i < list.size(); i++) {
-        Result match = list.at(i);
+    // find match by cursor position in the matches of the current file
+    for (int i : mCachedResults->fileRows(file)) {
+        Result match = mCachedResults->at(i);
 
-        if (file == match.filepath() && match.lineNr() == lineNr && match.colNr() == colNr - match.length()) {
-            updateNrMatches(list.indexOf(match) + 1);
+        if (match.lineNr() == lineNr && match.colNr() == colNr - match.length()) {
+            updateNrMatches(i + 1);
 
             if (resultsView() && !mHasChanged)
                 resultsView()->selectItem(i);
@@ -691,10 +784,14 @@ void SearchDialog::updateReplaceActionAvailability()
 
     bool activateReplace = ((edit && !edit->isReadOnly()) || (tm && (ui->combo_scope->currentIndex() != SearchScope::ThisFile)));
 
+    // while the ReplaceWorker rewrites files only its abort stays available
+    if (mReplacing) activateSearch = activateReplace = false;
+    ui->combo_scope->setEnabled(!mReplacing);
+
     // replace actions (!readonly):
     ui->txt_replace->setEnabled(activateReplace);
     ui->btn_Replace->setEnabled(activateReplace);
-    ui->btn_ReplaceAll->setEnabled(activateReplace);
+    ui->btn_ReplaceAll->setEnabled(activateReplace || mReplacing);
 
     // search actions (!gdx || !lst):
     ui->combo_search->setEnabled(activateSearch);
@@ -731,10 +828,7 @@ void SearchDialog::updateEditHighlighting()
 void SearchDialog::clearResults()
 {
     setSearchStatus(SearchStatus::Clear);
-
-    delete mCachedResults;
-    mCachedResults = nullptr;
-
+    releaseCachedResults();
 
     ProjectFileNode *fc = mMain->projectRepo()->findFileNode(mMain->recent()->editor());
     if (!fc) return;
@@ -870,12 +964,27 @@ QRegularExpression SearchDialog::createRegex()
 
 void SearchDialog::invalidateCache()
 {
-    delete mCachedResults;
-    mCachedResults = nullptr;
+    releaseCachedResults();
     mHasChanged = true;
     if (resultsView()) resultsView()->setOutdated();
 }
 
+void SearchDialog::releaseCachedResults()
+{
+    if (!mCachedResults) return;
+    if (mThread.isRunning()) {
+        // the worker queues results into the list until it finished
+        mThread.requestInterruption();
+        mThread.wait();
+    }
+    // an outdated results view keeps its list
+    if (mResultsView && mResultsView->resultList() == mCachedResults)
+        mCachedResults->setParent(mResultsView);
+    else
+        delete mCachedResults;
+    mCachedResults = nullptr;
+}
+
 bool SearchDialog::regex()
 {
     return ui->cb_regex->isChecked();
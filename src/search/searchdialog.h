@@ -39,6 +39,9 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include <QDialog>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTimer>
 #include "mainwindow.h"
 
 
@@ -93,6 +96,7 @@ public slots:
     void on_documentContentChanged(int from, int charsRemoved, int charsAdded);
     void finalUpdate();
     void intermediateUpdate();
+    void updateProgress(int filesDone, qint64 bytesScanned);
     void updateNrMatches(int current = 0, int max = -1);
 
 protected slots:
@@ -110,9 +114,12 @@ private slots:
     void on_cb_caseSens_stateChanged(int);
     void on_cb_wholeWords_stateChanged(int arg1);
     void on_cb_regex_stateChanged(int arg1);
+    void updateReplaceProgress(int filesDone, int hits);
+    void replaceFinished(const QVector<int> &hits);
 
 signals:
     void startSearch();
+    void startReplace();
 
 protected:
     void showEvent(QShowEvent *event);
@@ -145,13 +152,16 @@ private:
     void updateEditHighlighting();
     void setSearchOngoing(bool searching);
     void setSearchStatus(SearchStatus status);
-    int replaceOpened(FileMeta* fm, QRegularExpression regex, QString replaceTerm, QFlags<QTextDocument::FindFlag> flags);
-    int replaceUnopened(FileMeta* fm, QRegularExpression regex, QString replaceTerm);
+    void releaseCachedResults();
+    int replaceOpened(FileMeta* fm, QRegularExpression regex, QString replaceTerm);
+    void replaceUnopened(QList<FileMeta*> fml, QRegularExpression regex, QString replaceTerm);
+    void addReplaceHits(const QString &location, int hits);
+    void setReplaceOngoing(bool replacing);
 
 private:
     Ui::SearchDialog *ui;
     MainWindow *mMain;
-    ResultsView *mResultsView = nullptr;
+    QPointer<ResultsView> mResultsView;     // the log tabs may delete the view before the dialog
     SearchResultList *mCachedResults = nullptr;
     bool mHasChanged = true;
     TextView *mSplitSearchView = nullptr;
@@ -164,6 +174,19 @@ private:
     QThread mThread;
     bool mSearching = false;
     QMutex mMutex;
+    QTimer mUpdateTimer;
+    QElapsedTimer mSearchTime;
+    int mFileCount = 0;
+    int mFilesDone = 0;
+    qint64 mBytesScanned = 0;
+    QThread mReplaceThread;
+    bool mReplacing = false;
+    bool mReplaceAborted = false;
+    QStringList mReplaceFiles;      // the unopened files of the running replacement
+    QStringList mReplaceDetails;
+    int mReplaceHits = 0;
+    QString mReplaceSearchTerm;
+    QString mReplaceTerm;
 };
 
 }
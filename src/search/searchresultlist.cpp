@@ -18,12 +18,19 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "searchresultlist.h"
+#include "common.h"
 #include <QtDebug>
+#include <limits>
 
 namespace gams {
 namespace studio {
 namespace search {
 
+// Each stored context takes at most three UTF-8 bytes per QChar, so the contexts of all results stay addressable
+// by int offsets.
+static_assert(qint64(MAX_SEARCH_RESULTS) * SearchResultList::CMaxContextLength * 3 < std::numeric_limits<int>::max(),
+              "the contexts of MAX_SEARCH_RESULTS results must fit into a QByteArray");
+
 SearchResultList::SearchResultList(QRegularExpression regex) : mSearchRegex(regex)
 {
 }
@@ -32,25 +39,84 @@ SearchResultList::~SearchResultList()
 {
 }
 
-QList<Result> SearchResultList::resultsAsList() const
+void SearchResultList::addResult(int lineNr, int colNr, int length, QString fileLoc, QString context)
 {
-    QList<Result> result;
-    for (QList<Result> rl : mResultHash.values())
-        result << rl;
+    int row = mData.fileNr.size();
+    beginInsertRows(QModelIndex(), row, row);
+    appendRow(lineNr, colNr, length, fileLoc, context);
+    endInsertRows();
+    mResultCount.fetchAndAddOrdered(1);
+}
 
-    return result;
+void SearchResultList::queueResult(int lineNr, int colNr, int length, const QString &fileLoc, const QString &context)
+{
+    QMutexLocker locker(&mQueueMutex);
+    mQueue << QueuedResult {lineNr, colNr, length, fileLoc, context};
+    mResultCount.fetchAndAddOrdered(1);
 }
 
-void SearchResultList::addResult(int lineNr, int colNr, int length, QString fileLoc, QString context)
+int SearchResultList::fetchQueuedResults()
+{
+    QVector<QueuedResult> queue;
+    mQueueMutex.lock();
+    queue.swap(mQueue);
+    mQueueMutex.unlock();
+    if (queue.isEmpty()) return 0;
+
+    int row = mData.fileNr.size();
+    beginInsertRows(QModelIndex(), row, row + queue.size() - 1);
+    for (const QueuedResult &r : queue)
+        appendRow(r.lineNr, r.colNr, r.length, r.fileLoc, r.context);
+    endInsertRows();
+    return queue.size();
+}
+
+int SearchResultList::resultCount() const
 {
-    Result r = Result(lineNr, colNr, length, fileLoc, context);
-    mSize++;
-    mResultHash[fileLoc].append(r);
+    return mResultCount.load();
 }
 
-QList<Result> SearchResultList::filteredResultList(QString fileLocation)
+void SearchResultList::appendRow(int lineNr, int colNr, int length, const QString &fileLoc, const QString &context)
 {
-    return mResultHash.value(fileLocation);
+    int fileNr = mData.fileNrs.value(fileLoc, -1);
+    if (fileNr < 0) {
+        fileNr = mData.files.size();
+        mData.files << fileLoc;
+        mData.fileNrs.insert(fileLoc, fileNr);
+        mData.fileRows << QVector<int>();
+    }
+    int row = mData.fileNr.size();
+    bool whole = context.length() <= CMaxContextLength;
+    if (whole && row && mData.fileNr.last() == fileNr && mData.lineNr.last() == lineNr
+            && mData.lastContextWhole) {
+        mData.contextStart << mData.contextStart.last();
+        mData.contextSize << mData.contextSize.last();
+    } else {
+        // a long line is cut to a window around the match, so it can't be shared with other matches in the line
+        QByteArray utf8;
+        if (whole) {
+            utf8 = context.toUtf8();
+        } else {
+            int start = qBound(0, colNr - CMaxContextLength / 4, context.length() - CMaxContextLength);
+            utf8 = context.midRef(start, CMaxContextLength).toUtf8();
+        }
+        mData.contextStart << mData.contexts.size();
+        mData.contextSize << utf8.size();
+        mData.contexts.append(utf8);
+        mData.lastContextWhole = whole;
+    }
+    mData.fileNr << fileNr;
+    mData.lineNr << lineNr;
+    mData.colNr << colNr;
+    mData.length << length;
+    mData.fileRows[fileNr] << row;
+}
+
+const QVector<int> &SearchResultList::fileRows(const QString &fileLocation) const
+{
+    static const QVector<int> noRows;
+    int fileNr = mData.fileNrs.value(fileLocation, -1);
+    return fileNr < 0 ? noRows : mData.fileRows.at(fileNr);
 }
 
 void SearchResultList::setSearchRegex(QRegularExpression searchRegex)
@@ -65,14 +131,14 @@ QRegularExpression SearchResultList::searchRegex()
 
 int SearchResultList::size()
 {
-    return mSize;
+    return mData.fileNr.size();
 }
 
 int SearchResultList::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
         return 0;
-    return mSize;
+    return mData.fileNr.size();
 }
 
 int SearchResultList::columnCount(const QModelIndex &parent) const
@@ -88,14 +154,14 @@ QVariant SearchResultList::data(const QModelIndex &index, int role) const
         return QVariant();
     if (role == Qt::DisplayRole) {
         int row = index.row();
-
-        Result item = at(row);
+        if (row < 0 || row >= mData.fileNr.size())
+            return QVariant();
 
         switch(index.column())
         {
-        case 0: return item.filepath();
-        case 1: return item.lineNr();
-        case 2: return item.context();
+        case 0: return mData.files.at(mData.fileNr.at(row));
+        case 1: return mData.lineNr.at(row);
+        case 2: return context(row);
         }
     }
     return QVariant();
@@ -122,25 +188,17 @@ QVariant SearchResultList::headerData(int section, Qt::Orientation orientation,
 
 Result SearchResultList::at(int index) const
 {
-    int start = 0;
-    QList<QString> keys = mResultHash.keys();
-    QString key;
-
-    for (int i = 0; i < keys.size(); i++) {
-
-        // is in this list
-        if (index < (start + mResultHash.value(keys.at(i)).size()))
-            return mResultHash.value(keys.at(i)).at(index - start); // calc index
-        else
-            start += mResultHash.value(keys.at(i)).size(); // go to next list
+    if (index < 0 || index >= mData.fileNr.size()) {
+        qDebug() << "ERROR: SearchResultList::at out of bounds" << index;
+        return Result(0, 0, 0, "", ""); // this should never happen
     }
-    qDebug() << "ERROR: SearchResultList::at out of bounds" << index;
-    return Result(0, 0, 0, "", ""); // this should never happen
+    return Result(mData.lineNr.at(index), mData.colNr.at(index), mData.length.at(index),
+                  mData.files.at(mData.fileNr.at(index)), context(index));
 }
 
-QMultiHash<QString, QList<Result>> SearchResultList::resultHash() const
+QString SearchResultList::context(int index) const
 {
-    return mResultHash;
+    return QString::fromUtf8(mData.contexts.constData() + mData.contextStart.at(index), mData.contextSize.at(index));
 }
 
 }
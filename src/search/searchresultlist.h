@@ -21,6 +21,7 @@
 #define SEARCHRESULTLIST_H
 
 #include <QAbstractTableModel>
+#include <QMutex>
 #include <QRegularExpression>
 #include "result.h"
 
@@ -28,16 +29,25 @@ namespace gams {
 namespace studio {
 namespace search {
 
+///
+/// class SearchResultList
+/// Stores the search results in flat columns. The file locations are interned and each file has an index of its rows,
+/// so access by row and by file doesn't copy any results. Results of a running search are queued from the worker
+/// thread and appended to the model in batches by fetchQueuedResults().
+///
 class SearchResultList : public QAbstractTableModel
 {
     Q_OBJECT
 public:
+    static const int CMaxContextLength = 256;   ///< longer contexts are cut to a window around the match
+
     SearchResultList(QRegularExpression regex);
     virtual ~SearchResultList() override;
-    QList<Result> resultsAsList() const;
-    QMultiHash<QString, QList<Result> > resultHash() const;
     void addResult(int lineNr, int colNr, int length, QString fileLoc, QString context = "");
-    QList<Result> filteredResultList(QString fileLocation);
+    void queueResult(int lineNr, int colNr, int length, const QString &fileLoc, const QString &context);
+    int fetchQueuedResults();
+    int resultCount() const;
+    const QVector<int> &fileRows(const QString &fileLocation) const;
     QRegularExpression searchRegex();
     void setSearchRegex(QRegularExpression searchRegex);
     int size();
@@ -49,10 +59,34 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
 
 private:
-    QRegularExpression mSearchRegex;
-    int mSize = 0;
-    QHash<QString, QList<Result>> mResultHash;
+    struct QueuedResult {
+        int lineNr;
+        int colNr;
+        int length;
+        QString fileLoc;
+        QString context;
+    };
+    struct Columns {
+        QStringList files;                  // the interned file locations
+        QHash<QString, int> fileNrs;
+        QVector<QVector<int>> fileRows;     // the rows of each file in ascending order
+        QVector<int> fileNr;
+        QVector<int> lineNr;
+        QVector<int> colNr;
+        QVector<int> length;
+        QVector<int> contextStart;          // matches in the same line share the context
+        QVector<int> contextSize;
+        QByteArray contexts;                // the UTF-8 encoded contexts
+        bool lastContextWhole = false;      // the context of the last row isn't cut
+    };
+    void appendRow(int lineNr, int colNr, int length, const QString &fileLoc, const QString &context);
+    QString context(int index) const;
 
+    QRegularExpression mSearchRegex;
+    Columns mData;
+    QMutex mQueueMutex;
+    QVector<QueuedResult> mQueue;
+    QAtomicInt mResultCount;            // the rows and the queued results
 };
 
 }
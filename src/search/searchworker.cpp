@@ -19,65 +19,357 @@
  */
 #include "searchresultlist.h"
 #include "searchworker.h"
+#include "common.h"
+#include "editors/linescanner.h"
 
+#include <QElapsedTimer>
 #include <QFile>
-
-#include "file/filemeta.h"
+#include <QFileInfo>
+#include <QTextCodec>
+#include <QTextStream>
+#include <QThread>
+#include <QtConcurrent>
+#include <cstring>
 
 namespace gams {
 namespace studio {
 namespace search {
 
-SearchWorker::SearchWorker(QMutex& mutex, QRegularExpression regex, QList<FileMeta*> fml, SearchResultList* list)
-    : mMutex(mutex), mRegex(regex), mFiles(fml), mMatches(list)
+static const qint64 CRangeSize = 64*1024*1024;  // large files are split into ranges of this size
+static const int CBlockSize = 1024*1024;        // the size of the blocks read from the file
+static const int CCheckInterval = 1000;         // the count of lines between two checks for interruption
+static const int CProgressInterval = 100;       // the minimal time in ms between two progress signals
+
+static QString decode(QTextCodec *codec, const char *data, int size)
+{
+    return codec ? codec->toUnicode(data, size) : QString::fromUtf8(data, size);
+}
+
+SearchWorker::SearchWorker(QMutex& mutex, QRegularExpression regex, QList<SearchFile> files, SearchResultList* list)
+    : mMutex(mutex), mRegex(regex), mFiles(files), mMatches(list), mRangeSize(CRangeSize)
 {
+    if (!isLiteral(mRegex, mLiteral, mWholeWord))
+        mLiteral.clear();
 }
 
 SearchWorker::~SearchWorker()
 {
 }
 
+void SearchWorker::setRangeSize(qint64 rangeSize)
+{
+    mRangeSize = qMax(qint64(1), rangeSize);
+}
+
 void SearchWorker::findInFiles()
 {
     QMutexLocker m(&mMutex);
-    QList<Result> res;
-    for (FileMeta* fm : mFiles) {
-        int lineCounter = 0;
-        QFile file(fm->location());
-        if (file.open(QIODevice::ReadOnly)) {
-            QTextStream in(&file);
-            in.setCodec(fm->codec());
-
-            while (!in.atEnd()) { // read file
-
-                // abort: too many results
-                if (mMatches->size() > MAX_SEARCH_RESULTS-1) break;
-
-                lineCounter++;
-                if (lineCounter % 1000 == 0 && thread()->isInterruptionRequested()) break;
-
-                QString line = in.readLine();
-
-                QRegularExpressionMatch match;
-                QRegularExpressionMatchIterator i = mRegex.globalMatch(line);
-                while (i.hasNext()) {
-                    match = i.next();
-                    mMatches->addResult(lineCounter, match.capturedStart(), match.capturedLength(),
-                                       file.fileName(), line.trimmed());
-                }
-
-                // update periodically
-                if (lineCounter % 250000 == 0)
-                    emit update();
+    QThread *owner = thread();
+    createWorkItems();
+    mNextItem = 0;
+    mMergedCount = mMatches->resultCount();
+    mBytesScanned.store(0);
+
+    // each worker takes the next pending item as soon as it is idle
+    QVector<QFuture<void>> workers;
+    int workerCount = qMin(QThread::idealThreadCount(), mItems.size());
+    for (int i = 0; i < workerCount; ++i)
+        workers << QtConcurrent::run(this, &SearchWorker::processItems, owner);
+
+    // merge the results in the order of files and lines
+    int lineOffset = 0;
+    int filesDone = 0;
+    QElapsedTimer progressTime;
+    progressTime.start();
+    for (int i = 0; i < mItems.size(); ++i) {
+        mItemMutex.lock();
+        while (!mItems.at(i).done) {
+            mItemDone.wait(&mItemMutex, CProgressInterval);
+            if (progressTime.elapsed() >= CProgressInterval) {
+                emit progress(filesDone, mBytesScanned.load());
+                progressTime.restart();
+            }
+        }
+        mItemMutex.unlock();
+
+        WorkItem &item = mItems[i];
+        if (i > 0 && mItems.at(i-1).file != item.file) lineOffset = 0;
+        const QString &location = mFiles.at(item.file).location;
+        for (const LineMatch &lm : item.matches) {
+            // abort: too many results
+            if (mMatches->resultCount() > MAX_SEARCH_RESULTS-1) break;
+            mMatches->queueResult(lineOffset + lm.lineNr, lm.colNr, lm.length, location, lm.context);
+        }
+        mMergedCount = mMatches->resultCount();
+        item.matches = QVector<LineMatch>();
+        lineOffset += item.lineCount;
+
+        if (i+1 == mItems.size() || mItems.at(i+1).file != item.file) {
+            ++filesDone;
+            if (progressTime.elapsed() >= CProgressInterval) {
+                emit progress(filesDone, mBytesScanned.load());
+                progressTime.restart();
             }
-            file.close();
         }
-        emit update();
     }
+    for (QFuture<void> &worker : workers)
+        worker.waitForFinished();
+    mItems.clear();
+    emit progress(filesDone, mBytesScanned.load());
+
     emit resultReady();
     thread()->quit();
 }
 
+void SearchWorker::createWorkItems()
+{
+    mItems.clear();
+    for (int i = 0; i < mFiles.size(); ++i) {
+        qint64 size = QFileInfo(mFiles.at(i).location).size();
+        if (size <= mRangeSize || !isSplittable(mFiles.at(i).codec)) {
+            WorkItem item;
+            item.file = i;
+            mItems << item;
+            continue;
+        }
+        for (qint64 start = 0; start < size; start += mRangeSize) {
+            WorkItem item;
+            item.file = i;
+            item.start = start;
+            item.end = qMin(start + mRangeSize, size);
+            mItems << item;
+        }
+    }
+}
+
+void SearchWorker::processItems(QThread *owner)
+{
+    QRegularExpression regex(mRegex.pattern(), mRegex.patternOptions());
+    int i;
+    while ((i = mNextItem.fetchAndAddOrdered(1)) < mItems.size()) {
+        WorkItem &item = mItems[i];
+        // skipped items are marked as done to let the merge run to the end
+        if (!owner->isInterruptionRequested() && mMergedCount < MAX_SEARCH_RESULTS)
+            findInItem(item, regex, owner);
+        QMutexLocker locker(&mItemMutex);
+        item.done = true;
+        mItemDone.wakeAll();
+    }
+}
+
+void SearchWorker::findInItem(WorkItem &item, const QRegularExpression &regex, QThread *owner)
+{
+    QTextCodec *codec = mFiles.at(item.file).codec;
+    if (!isSplittable(codec)) {
+        findInStream(item, regex, owner);
+        return;
+    }
+    LiteralScanner scanner = literalScanner(codec);
+    if (scanner.isValid())
+        findLiteral(item, scanner, owner);
+    else
+        findInLines(item, regex, owner);
+}
+
+void SearchWorker::findInStream(WorkItem &item, const QRegularExpression &regex, QThread *owner)
+{
+    QFile file(mFiles.at(item.file).location);
+    if (!file.open(QIODevice::ReadOnly)) return;
+    QTextStream in(&file);
+    in.setCodec(mFiles.at(item.file).codec);
+
+    while (!in.atEnd()) {
+        if (item.matches.size() > MAX_SEARCH_RESULTS-1) break;
+        item.lineCount++;
+        if (item.lineCount % CCheckInterval == 0 && owner->isInterruptionRequested()) break;
+
+        QString line = in.readLine();
+        QRegularExpressionMatchIterator i = regex.globalMatch(line);
+        while (i.hasNext()) {
+            QRegularExpressionMatch match = i.next();
+            item.matches << LineMatch {item.lineCount, match.capturedStart(), match.capturedLength(), line.trimmed()};
+        }
+    }
+    mBytesScanned.fetchAndAddRelaxed(file.pos());
+}
+
+void SearchWorker::findInLines(WorkItem &item, const QRegularExpression &regex, QThread *owner)
+{
+    QFile file(mFiles.at(item.file).location);
+    if (!file.open(QIODevice::ReadOnly)) return;
+    QTextCodec *codec = mFiles.at(item.file).codec;
+    qint64 end = item.end < 0 ? file.size() : item.end;
+    if (item.start > 0) {
+        // the line containing the start belongs to the previous range
+        file.seek(item.start - 1);
+        file.readLine();
+    }
+
+    QByteArray buffer;
+    qint64 bufferPos = file.pos();  // the position of buffer[0] in the file
+    int from = 0;                   // the start of the current line in the buffer
+    bool atEnd = false;
+    while (bufferPos + from < end) {
+        const char *data = buffer.constData();
+        const char *lf = static_cast<const char*>(memchr(data + from, '\n', size_t(buffer.size() - from)));
+        if (!lf && !atEnd) {
+            // keep the incomplete line and read the next block
+            buffer.remove(0, from);
+            bufferPos += from;
+            from = 0;
+            QByteArray block = file.read(CBlockSize);
+            mBytesScanned.fetchAndAddRelaxed(block.size());
+            if (block.isEmpty()) atEnd = true;
+            else buffer.append(block);
+            continue;
+        }
+        if (!lf && from >= buffer.size()) break;
+        if (item.matches.size() > MAX_SEARCH_RESULTS-1) break;
+        item.lineCount++;
+        if (item.lineCount % CCheckInterval == 0 && owner->isInterruptionRequested()) break;
+
+        int lineEnd = lf ? int(lf - data) : buffer.size();
+        int len = lineEnd - from;
+        if (len && data[from + len - 1] == '\r') --len;
+        QString line = decode(codec, data + from, len);
+        QRegularExpressionMatchIterator i = regex.globalMatch(line);
+        while (i.hasNext()) {
+            QRegularExpressionMatch match = i.next();
+            item.matches << LineMatch {item.lineCount, match.capturedStart(), match.capturedLength(), line.trimmed()};
+        }
+        from = lineEnd + 1;
+    }
+}
+
+void SearchWorker::findLiteral(WorkItem &item, const LiteralScanner &scanner, QThread *owner)
+{
+    QFile file(mFiles.at(item.file).location);
+    if (!file.open(QIODevice::ReadOnly)) return;
+    QTextCodec *codec = mFiles.at(item.file).codec;
+    qint64 end = item.end < 0 ? file.size() : item.end;
+    if (item.start > 0) {
+        // the line containing the start belongs to the previous range
+        file.seek(item.start - 1);
+        file.readLine();
+    }
+
+    QByteArray buffer;
+    qint64 bufferPos = file.pos();  // the position of buffer[0] in the file
+    bool done = false;
+    while (!done && bufferPos < end) {
+        if (owner->isInterruptionRequested() || item.matches.size() > MAX_SEARCH_RESULTS-1) break;
+        QByteArray block = file.read(CBlockSize);
+        mBytesScanned.fetchAndAddRelaxed(block.size());
+        if (block.isEmpty()) done = true;
+        else buffer.append(block);
+
+        // only complete lines are scanned, at the end of the file the last line is complete
+        int size = done ? buffer.size() : buffer.lastIndexOf('\n') + 1;
+        if (!size) continue;
+        if (bufferPos + size > end) {
+            // stop after the line containing the end of the range
+            int lastLf = buffer.indexOf('\n', int(end - bufferPos - 1));
+            if (lastLf >= 0) size = lastLf + 1;
+            done = true;
+        }
+
+        // only the lines containing a match are decoded
+        const char *data = buffer.constData();
+        int lineStart = 0;
+        int pos = scanner.indexIn(data, 0, size);
+        while (pos >= 0) {
+            int lines = LineScanner::count(data + lineStart, pos - lineStart, '\n');
+            if (lines) {
+                item.lineCount += lines;
+                lineStart = pos;
+                while (data[lineStart-1] != '\n') --lineStart;
+            }
+            const char *lf = static_cast<const char*>(memchr(data + pos, '\n', size_t(size - pos)));
+            int lineEnd = lf ? int(lf - data) : size;
+            int len = lineEnd - lineStart;
+            if (len && data[lineStart + len - 1] == '\r') --len;
+            ++item.lineCount;
+
+            QString context = decode(codec, data + lineStart, len).trimmed();
+            while (pos >= 0 && pos < lineEnd) {
+                if (item.matches.size() > MAX_SEARCH_RESULTS-1) break;
+                int colNr = decode(codec, data + lineStart, pos - lineStart).length();
+                item.matches << LineMatch {item.lineCount, colNr, mLiteral.length(), context};
+                pos = scanner.indexIn(data, pos + scanner.length(), size);
+            }
+            if (item.matches.size() > MAX_SEARCH_RESULTS-1) break;
+            lineStart = lineEnd + 1;
+        }
+        item.lineCount += LineScanner::count(data + lineStart, size - lineStart, '\n');
+        if (lineStart < size && data[size-1] != '\n') ++item.lineCount;
+
+        buffer.remove(0, size);
+        bufferPos += size;
+    }
+}
+
+bool SearchWorker::isSplittable(QTextCodec *codec)
+{
+    // lines can be separated on byte level for all codecs but UTF-16 and UTF-32
+    if (!codec) return true;
+    int mib = codec->mibEnum();
+    return mib != 1013 && mib != 1014 && mib != 1015 && mib != 1017 && mib != 1018 && mib != 1019;
+}
+
+LiteralScanner SearchWorker::literalScanner(QTextCodec *codec) const
+{
+    if (mLiteral.isEmpty()) return LiteralScanner();
+
+    // the bytes of a literal must not be part of other characters: UTF-8 and single-byte codecs only
+    int mib = codec ? codec->mibEnum() : 106;
+    bool byteCodec = mib == 3 || mib == 106 || (mib >= 4 && mib <= 13) || (mib >= 109 && mib <= 112)
+            || (mib >= 2250 && mib <= 2258);
+    if (!byteCodec) return LiteralScanner();
+
+    bool caseSensitive = !(mRegex.patternOptions() & QRegularExpression::CaseInsensitiveOption);
+    bool ascii = true;
+    for (const QChar &c : mLiteral)
+        if (c.unicode() > 127) ascii = false;
+    // case folding is done for ASCII only
+    if (!ascii && !caseSensitive) return LiteralScanner();
+
+    QByteArray bytes = codec ? codec->fromUnicode(mLiteral) : mLiteral.toUtf8();
+    if (decode(codec, bytes.constData(), bytes.size()) != mLiteral) return LiteralScanner();
+    return LiteralScanner(bytes, caseSensitive, mWholeWord);
+}
+
+bool SearchWorker::isLiteral(const QRegularExpression &regex, QString &literal, bool &wholeWord)
+{
+    if (regex.patternOptions() & ~QRegularExpression::PatternOptions(QRegularExpression::CaseInsensitiveOption))
+        return false;
+    const QString pattern = regex.pattern();
+    const QString metaChars("^$.|?*+()[]{}");
+    bool wordStart = false;
+    bool wordEnd = false;
+    literal.clear();
+    for (int i = 0; i < pattern.length(); ++i) {
+        QChar c = pattern.at(i);
+        if (wordEnd) return false;
+        if (c == '\\') {
+            if (++i == pattern.length()) return false;
+            c = pattern.at(i);
+            if (c == 'b') {
+                // word boundaries are supported around the literal, as created for whole words
+                if (i == 1) wordStart = true;
+                else wordEnd = true;
+                continue;
+            }
+            if (c.isLetterOrNumber()) return false;
+        } else if (metaChars.contains(c)) {
+            return false;
+        }
+        if (c == '\n' || c == '\r') return false;
+        literal += c;
+    }
+    wholeWord = wordStart && wordEnd;
+    return !literal.isEmpty() && wordStart == wordEnd;
+}
+
 }
 }
 }
@@ -20,35 +20,85 @@
 #ifndef SEARCHWORKER_H
 #define SEARCHWORKER_H
 
+#include "literalscanner.h"
 #include <QMutex>
 #include <QObject>
 #include <QRegularExpression>
+#include <QVector>
+#include <QWaitCondition>
+
+class QTextCodec;
 
 namespace gams {
 namespace studio {
-
-class FileMeta;
-
 namespace search {
 
+///
+/// \brief The SearchFile struct describes a file to search in.
+///
+struct SearchFile {
+    SearchFile(QString _location = QString(), QTextCodec *_codec = nullptr)
+        : location(_location), codec(_codec) {}
+    QString location;
+    QTextCodec *codec;
+};
+
 class SearchResultList;
 class SearchWorker : public QObject
 {
     Q_OBJECT
 public:
-    SearchWorker(QMutex& mutex, QRegularExpression regex, QList<FileMeta*> fml, SearchResultList* list);
+    SearchWorker(QMutex& mutex, QRegularExpression regex, QList<SearchFile> files, SearchResultList* list);
     ~SearchWorker();
     void findInFiles();
+    void setRangeSize(qint64 rangeSize);
+
+    /// Returns true if the lines of the encoded data can be separated on byte level.
+    static bool isSplittable(QTextCodec *codec);
 
 signals:
-    void update();
+    void progress(int filesDone, qint64 bytesScanned);
     void resultReady();
 
 private:
+    struct LineMatch {
+        int lineNr;     // relative to the start of the work item
+        int colNr;
+        int length;
+        QString context;
+    };
+    struct WorkItem {
+        int file = 0;
+        qint64 start = 0;
+        qint64 end = -1;            // -1 for the whole file
+        int lineCount = 0;
+        bool done = false;
+        QVector<LineMatch> matches;
+    };
+
+    void createWorkItems();
+    void processItems(QThread *owner);
+    void findInItem(WorkItem &item, const QRegularExpression &regex, QThread *owner);
+    void findInStream(WorkItem &item, const QRegularExpression &regex, QThread *owner);
+    void findInLines(WorkItem &item, const QRegularExpression &regex, QThread *owner);
+    void findLiteral(WorkItem &item, const LiteralScanner &scanner, QThread *owner);
+    LiteralScanner literalScanner(QTextCodec *codec) const;
+    static bool isLiteral(const QRegularExpression &regex, QString &literal, bool &wholeWord);
+
     QMutex& mMutex;
     QRegularExpression mRegex;
-    QList<FileMeta*> mFiles;
+    QList<SearchFile> mFiles;
     SearchResultList* mMatches;
+    qint64 mRangeSize;
+    QString mLiteral;               // the search term if the regex has no metacharacters
+    bool mWholeWord = false;
+
+    QVector<WorkItem> mItems;
+    QAtomicInt mNextItem;
+    QAtomicInt mMergedCount;        // the count of results in mMatches
+    QAtomicInteger<qint64> mBytesScanned;
+    QMutex mItemMutex;
+    QWaitCondition mItemDone;
 };
 
 }
@@ -0,0 +1,448 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "trigramindex.h"
+#include "logger.h"
+
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtAlgorithms>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace gams {
+namespace studio {
+namespace search {
+
+static const quint32 CIndexMagic = 0x47535449;   // "GSTI"
+static const quint32 CIndexVersion = 2;
+static const int CTrigramCount = 1 << 24;
+static const int CMinBitsLog2 = 10;
+static const int CMaxBitsLog2 = 24;
+static const int CBlockSize = 1024*1024;
+static const int CHashSize = 4096;              // the size of the first and the last block in the content hash
+static const qint64 CSaveInterval = 60000;      // the minimal time in ms between two saves while indexing
+
+static inline uchar foldCase(uchar c)
+{
+    return (c >= 'A' && c <= 'Z') ? uchar(c | 0x20) : c;
+}
+
+static int skipEscape(const QString &pattern, int i)
+{
+    // i is the index of the letter or digit following the backslash, returns the index of the last character
+    const int len = pattern.length();
+    const QChar c = pattern.at(i);
+    int next = i + 1;
+    if (c == 'Q') {
+        // quoted text is skipped
+        int end = pattern.indexOf("\\E", next);
+        return end < 0 ? len - 1 : end + 1;
+    }
+    if (next < len && (pattern.at(next) == '{' || pattern.at(next) == '<' || pattern.at(next) == '\'')) {
+        QChar close = pattern.at(next) == '{' ? '}' : pattern.at(next) == '<' ? '>' : '\'';
+        int end = pattern.indexOf(close, next + 1);
+        return end < 0 ? len - 1 : end;
+    }
+    if (c == 'x') {
+        while (next < len && next <= i + 2 && QString("0123456789abcdefABCDEF").contains(pattern.at(next))) ++next;
+        return next - 1;
+    }
+    if (c == 'g' && next < len && (pattern.at(next) == '-' || pattern.at(next) == '+')) ++next;
+    if (c.isDigit() || c == 'g') {
+        while (next < len && pattern.at(next).isDigit()) ++next;
+        return next - 1;
+    }
+    if (c == 'c' || c == 'p' || c == 'P')
+        return qMin(next, len - 1);
+    return i;
+}
+
+static int skipClass(const QString &pattern, int i)
+{
+    // i is the index of the opening bracket, returns the index of the closing one
+    const int len = pattern.length();
+    int j = i + 1;
+    if (j < len && pattern.at(j) == '^') ++j;
+    if (j < len && pattern.at(j) == ']') ++j;
+    while (j < len && pattern.at(j) != ']') {
+        if (pattern.at(j) == '\\') {
+            ++j;
+        } else if (pattern.at(j) == '[' && j + 1 < len && pattern.at(j + 1) == ':') {
+            int end = pattern.indexOf(":]", j + 2);
+            if (end > 0) j = end + 1;
+        }
+        ++j;
+    }
+    return qMin(j, len - 1);
+}
+
+TrigramIndex::TrigramIndex(const QString &indexFile, QObject *parent)
+    : QObject(parent), mIndexFile(indexFile)
+{
+    // the stored index is loaded by the background thread
+    QMutexLocker locker(&mMutex);
+    mRunning = true;
+    mRunner = QtConcurrent::run(this, &TrigramIndex::run);
+}
+
+TrigramIndex::~TrigramIndex()
+{
+    mStop.store(1);
+    mRunner.waitForFinished();
+    if (mDirty) save();
+}
+
+void TrigramIndex::update(const QString &location)
+{
+    if (location.isEmpty()) return;
+    QMutexLocker locker(&mMutex);
+    auto it = mEntries.find(location);
+    if (it != mEntries.end()) it->valid = false;
+    if (!mPendingSet.contains(location)) {
+        mPendingSet.insert(location);
+        mPending << location;
+    }
+    if (!mRunning && !mStop.load()) {
+        mRunning = true;
+        mRunner = QtConcurrent::run(this, &TrigramIndex::run);
+    }
+}
+
+void TrigramIndex::remove(const QString &location)
+{
+    QMutexLocker locker(&mMutex);
+    if (mEntries.remove(location)) mDirty = true;
+}
+
+bool TrigramIndex::mayContain(const QString &location, const QVector<quint32> &trigrams)
+{
+    if (trigrams.isEmpty()) return true;
+    // only an in-memory lookup, the background thread validates the entries against the files
+    bool stale;
+    {
+        QMutexLocker locker(&mMutex);
+        auto it = mEntries.constFind(location);
+        if (it != mEntries.constEnd() && it->valid) {
+            const uchar *bits = reinterpret_cast<const uchar*>(it->bits.constData());
+            for (quint32 trigram : trigrams) {
+                quint32 bit = bitOf(trigram, it->bitsLog2);
+                if (!(bits[bit >> 3] & (1 << (bit & 7)))) return false;
+            }
+            return true;
+        }
+        stale = mLoaded && !mPendingSet.contains(location);
+    }
+    // unknown files and files that aren't validated yet are indexed again
+    if (stale) update(location);
+    return true;
+}
+
+void TrigramIndex::waitForIndexing()
+{
+    forever {
+        QFuture<void> runner;
+        {
+            QMutexLocker locker(&mMutex);
+            if (!mRunning) break;
+            runner = mRunner;
+        }
+        runner.waitForFinished();
+    }
+}
+
+int TrigramIndex::indexedFiles() const
+{
+    QMutexLocker locker(&mMutex);
+    return mEntries.size();
+}
+
+QVector<quint32> TrigramIndex::trigrams(const QRegularExpression &regex)
+{
+    QVector<quint32> res;
+    if (regex.patternOptions() & QRegularExpression::ExtendedPatternSyntaxOption) return res;
+
+    const QString pattern = regex.pattern();
+    QStringList runs;       // the literal parts each match contains
+    QString run;
+    int depth = 0;          // groups are skipped, they may be optional or contain alternatives
+    for (int i = 0; i < pattern.length(); ++i) {
+        QChar c = pattern.at(i);
+        if (c == '\\') {
+            if (++i == pattern.length()) break;
+            c = pattern.at(i);
+            if (c.isLetterOrNumber()) {
+                // character types, anchors, references and other escape sequences
+                runs << run;
+                run.clear();
+                i = skipEscape(pattern, i);
+                continue;
+            }
+            if (depth) continue;
+        } else if (c == '[') {
+            i = skipClass(pattern, i);
+            runs << run;
+            run.clear();
+            continue;
+        } else if (c == '(') {
+            ++depth;
+            runs << run;
+            run.clear();
+            continue;
+        } else if (c == ')') {
+            if (depth) --depth;
+            continue;
+        } else if (depth) {
+            continue;
+        } else if (c == '|') {
+            return res;
+        } else if (c == '?' || c == '*' || c == '{') {
+            // the preceding character is optional
+            run.chop(1);
+            runs << run;
+            run.clear();
+            if (c == '{') {
+                int end = pattern.indexOf('}', i);
+                if (end > i) i = end;
+            }
+            continue;
+        } else if (c == '+' || c == '.' || c == '^' || c == '$') {
+            runs << run;
+            run.clear();
+            continue;
+        }
+        run += c;
+    }
+    runs << run;
+
+    // caseless matching lets k and s match non-ASCII characters (kelvin sign and long s)
+    bool caseless = (regex.patternOptions() & QRegularExpression::CaseInsensitiveOption) || pattern.contains("(?");
+    for (const QString &part : runs) {
+        quint32 trigram = 0;
+        int len = 0;
+        for (const QChar &c : part) {
+            ushort u = c.unicode();
+            // non-ASCII characters are encoded differently by the codecs
+            if (u > 127 || u == '\n' || u == '\r' || (caseless && ((u | 0x20) == 'k' || (u | 0x20) == 's'))) {
+                len = 0;
+                continue;
+            }
+            trigram = ((trigram << 8) | foldCase(uchar(u))) & 0xffffff;
+            if (++len >= 3) res << trigram;
+        }
+    }
+    std::sort(res.begin(), res.end());
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+    return res;
+}
+
+void TrigramIndex::run()
+{
+    if (!mLoaded) load();
+    QVector<quint64> trigramSet(CTrigramCount / 64);
+    forever {
+        while (!mStop.load()) {
+            QString location;
+            {
+                QMutexLocker locker(&mMutex);
+                if (mPending.isEmpty()) break;
+                location = mPending.takeFirst();
+                mPendingSet.remove(location);
+            }
+            QFileInfo fi(location);
+            qint64 modified = fi.lastModified().toMSecsSinceEpoch();
+            QFile file(location);
+            QByteArray hash;
+            if (fi.isFile() && file.open(QFile::ReadOnly)) hash = contentHash(file);
+            {
+                QMutexLocker locker(&mMutex);
+                auto it = mEntries.find(location);
+                if (!fi.isFile()) {
+                    if (it != mEntries.end()) {
+                        mEntries.erase(it);
+                        mDirty = true;
+                    }
+                    continue;
+                }
+                if (it != mEntries.end() && it->size == fi.size() && it->modified == modified && it->hash == hash) {
+                    // unless the file has been queued again meanwhile
+                    if (!mPendingSet.contains(location)) it->valid = true;
+                    continue;
+                }
+            }
+            if (!file.isOpen()) continue;
+            Entry entry;
+            entry.size = fi.size();
+            entry.modified = modified;
+            entry.hash = hash;
+            if (!indexFile(file, entry, trigramSet)) continue;
+            QMutexLocker locker(&mMutex);
+            entry.valid = !mPendingSet.contains(location);
+            mEntries.insert(location, entry);
+            mDirty = true;
+        }
+        bool dirty;
+        {
+            QMutexLocker locker(&mMutex);
+            dirty = mDirty;
+        }
+        if (dirty && !mStop.load() && (!mLastSave.isValid() || mLastSave.hasExpired(CSaveInterval)))
+            save();
+
+        QMutexLocker locker(&mMutex);
+        if (mPending.isEmpty() || mStop.load()) {
+            mRunning = false;
+            break;
+        }
+    }
+    emit indexed();
+}
+
+bool TrigramIndex::indexFile(QFile &file, Entry &entry, QVector<quint64> &trigramSet)
+{
+    if (!file.seek(0)) return false;
+
+    // collect the distinct trigrams of the file
+    quint64 *set = trigramSet.data();
+    int distinct = 0;
+    quint32 trigram = 0;
+    int len = 0;
+    QByteArray block;
+    while (!(block = file.read(CBlockSize)).isEmpty() && !mStop.load()) {
+        const uchar *data = reinterpret_cast<const uchar*>(block.constData());
+        for (int i = 0; i < block.size(); ++i) {
+            uchar c = data[i];
+            if (c == '\n' || c == '\r') {
+                len = 0;
+                continue;
+            }
+            trigram = ((trigram << 8) | foldCase(c)) & 0xffffff;
+            if (++len < 3) continue;
+            quint64 &word = set[trigram >> 6];
+            quint64 bit = quint64(1) << (trigram & 63);
+            if (!(word & bit)) {
+                word |= bit;
+                ++distinct;
+            }
+        }
+    }
+
+    // about four bits per distinct trigram keep false positives rare
+    int bitsLog2 = CMinBitsLog2;
+    while (bitsLog2 < CMaxBitsLog2 && (1 << bitsLog2) < distinct * 4) ++bitsLog2;
+    entry.bitsLog2 = bitsLog2;
+    entry.bits = QByteArray((1 << bitsLog2) / 8, '\0');
+    uchar *bits = reinterpret_cast<uchar*>(entry.bits.data());
+    for (int w = 0; distinct && w < trigramSet.size(); ++w) {
+        quint64 word = set[w];
+        if (!word) continue;
+        set[w] = 0;
+        while (word) {
+            quint32 bit = bitOf(quint32(w * 64) + qCountTrailingZeroBits(word), bitsLog2);
+            bits[bit >> 3] |= uchar(1 << (bit & 7));
+            word &= word - 1;
+            --distinct;
+        }
+    }
+    return !mStop.load();
+}
+
+void TrigramIndex::load()
+{
+    QHash<QString, Entry> entries;
+    QFile file(mIndexFile);
+    if (!mIndexFile.isEmpty() && file.open(QFile::ReadOnly)) {
+        QDataStream in(&file);
+        quint32 magic;
+        quint32 version;
+        qint32 count;
+        in >> magic >> version >> count;
+        if (in.status() == QDataStream::Ok && magic == CIndexMagic && version == CIndexVersion) {
+            for (int i = 0; i < count && !mStop.load(); ++i) {
+                QString location;
+                Entry entry;
+                qint32 bitsLog2;
+                in >> location >> entry.size >> entry.modified >> entry.hash >> bitsLog2 >> entry.bits;
+                if (in.status() != QDataStream::Ok) {
+                    DEB() << "Invalid search index " << mIndexFile;
+                    entries.clear();
+                    break;
+                }
+                if (bitsLog2 < CMinBitsLog2 || bitsLog2 > CMaxBitsLog2 || entry.bits.size() != (1 << bitsLog2) / 8)
+                    continue;
+                entry.bitsLog2 = bitsLog2;
+                entries.insert(location, entry);
+            }
+        }
+    }
+    QMutexLocker locker(&mMutex);
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        if (!mEntries.contains(it.key()))
+            mEntries.insert(it.key(), it.value());
+    }
+    mLoaded = true;
+}
+
+void TrigramIndex::save()
+{
+    QHash<QString, Entry> entries;
+    {
+        QMutexLocker locker(&mMutex);
+        entries = mEntries;
+        mDirty = false;
+    }
+    mLastSave.start();
+    if (mIndexFile.isEmpty() || !QDir().mkpath(QFileInfo(mIndexFile).path())) return;
+    QSaveFile file(mIndexFile);
+    if (!file.open(QFile::WriteOnly)) {
+        DEB() << "Could not write search index " << mIndexFile;
+        return;
+    }
+    QDataStream out(&file);
+    out << CIndexMagic << CIndexVersion << qint32(entries.size());
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+        out << it.key() << it->size << it->modified << it->hash << qint32(it->bitsLog2) << it->bits;
+    file.commit();
+}
+
+quint32 TrigramIndex::bitOf(quint32 trigram, int bitsLog2)
+{
+    return (trigram * 2654435761u) >> (32 - bitsLog2);
+}
+
+QByteArray TrigramIndex::contentHash(QFile &file)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    file.seek(0);
+    hash.addData(file.read(CHashSize));
+    if (file.size() > CHashSize) {
+        file.seek(qMax(qint64(CHashSize), file.size() - CHashSize));
+        hash.addData(file.read(CHashSize));
+    }
+    return hash.result();
+}
+
+} // namespace search
+} // namespace studio
+} // namespace gams
@@ -0,0 +1,98 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+
+namespace gams {
+namespace studio {
+namespace search {
+
+///
+/// class TrigramIndex
+/// Keeps a compact set of the (ASCII case-folded) trigrams of each indexed file. Files are indexed in a background
+/// thread and the index is persisted in a file. A file can only contain a match of a regex if it contains all
+/// trigrams that are required by the regex. An entry is only used after the background thread validated it against
+/// the size, the modification time and a hash of the first and the last block of the file. Calling update marks the
+/// entry as changed, so the file is a candidate until it is validated or indexed again.
+///
+class TrigramIndex : public QObject
+{
+    Q_OBJECT
+public:
+    TrigramIndex(const QString &indexFile, QObject *parent = nullptr);
+    ~TrigramIndex() override;
+
+    void update(const QString &location);
+    void remove(const QString &location);
+    /// Only looks up the index, unknown and unvalidated files are queued for indexing.
+    bool mayContain(const QString &location, const QVector<quint32> &trigrams);
+    void waitForIndexing();
+    int indexedFiles() const;
+
+    /// Returns the sorted trigrams each match of the regex contains, an empty list if no file can be skipped.
+    static QVector<quint32> trigrams(const QRegularExpression &regex);
+
+signals:
+    void indexed();
+
+private:
+    struct Entry {
+        qint64 size = -1;
+        qint64 modified = 0;
+        QByteArray hash;            // fingerprint of the first and the last block
+        int bitsLog2 = 0;
+        QByteArray bits;            // a bit for each hashed trigram
+        bool valid = false;         // the entry matches the file, a loaded entry isn't validated yet
+    };
+    void run();
+    bool indexFile(QFile &file, Entry &entry, QVector<quint64> &trigramSet);
+    void load();
+    void save();
+    static quint32 bitOf(quint32 trigram, int bitsLog2);
+    static QByteArray contentHash(QFile &file);
+
+    QString mIndexFile;
+    mutable QMutex mMutex;
+    QHash<QString, Entry> mEntries;
+    QStringList mPending;
+    QSet<QString> mPendingSet;
+    QFuture<void> mRunner;
+    bool mRunning = false;
+    bool mLoaded = false;
+    bool mDirty = false;
+    QElapsedTimer mLastSave;
+    QAtomicInt mStop;
+};
+
+} // namespace search
+} // namespace studio
+} // namespace gams
+
+#endif // TRIGRAMINDEX_H
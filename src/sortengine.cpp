@@ -0,0 +1,182 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sortengine.h"
+
+#include <QCollator>
+#include <cstring>
+
+namespace gams {
+namespace studio {
+
+namespace {
+
+const int CDigitBits = 11;              // the keys are sorted in six passes of 11 bits
+const int CDigits = 1 << CDigitBits;
+
+struct Chunk {
+    size_t from;
+    size_t to;
+    quint64 first = 0;      // the key of the first item
+    quint64 diff = 0;       // the bits that differ from the first key
+    size_t counts[CDigits];
+};
+
+template<typename Func>
+void forEachChunk(QVector<Chunk> &chunks, Func func)
+{
+    if (chunks.size() == 1)
+        func(chunks[0]);
+    else
+        QtConcurrent::blockingMap(chunks, func);
+}
+
+template<typename Equal>
+std::vector<int> ranksOf(const std::vector<int> &order, Equal equal)
+{
+    std::vector<int> ranks(order.size());
+    int rank = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i && !equal(order[i-1], order[i])) ++rank;
+        ranks[size_t(order[i])] = rank;
+    }
+    return ranks;
+}
+
+} // namespace
+
+void SortEngine::addKey(SortEngine::KeyFunc key, Qt::SortOrder order)
+{
+    mKeys << Key {key, order};
+}
+
+void SortEngine::setCancelFlag(const QAtomicInt *cancel)
+{
+    mCancel = cancel;
+}
+
+bool SortEngine::sort(std::vector<int> &indices) const
+{
+    // a stable sort by each key, starting with the least significant one
+    std::vector<int> work = indices;
+    for (int i = mKeys.size()-1; i >= 0; --i) {
+        if (!radixSort(work, mKeys.at(i)))
+            return false;
+    }
+    indices.swap(work);
+    return true;
+}
+
+quint64 SortEngine::intKey(qint64 val)
+{
+    return quint64(val) ^ (quint64(1) << 63);
+}
+
+quint64 SortEngine::doubleKey(double val)
+{
+    // the IEEE 754 bits of positive values keep their order with the sign bit set, negative values are inverted
+    if (val == 0.0) val = 0.0; // -0.0 equals 0.0
+    quint64 bits;
+    memcpy(&bits, &val, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | (quint64(1) << 63);
+}
+
+std::vector<int> SortEngine::stringRanks(const QStringList &strings, bool localeAware)
+{
+    std::vector<int> order(size_t(strings.size()));
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = int(i);
+    if (!localeAware) {
+        parallelSort(order, [&strings](int a, int b) {
+            int res = strings.at(a).compare(strings.at(b));
+            return res ? res < 0 : a < b;
+        });
+        return ranksOf(order, [&strings](int a, int b) { return strings.at(a) == strings.at(b); });
+    }
+    QCollator collator;
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(size_t(strings.size()));
+    for (const QString &str : strings)
+        keys.push_back(collator.sortKey(str));
+    parallelSort(order, [&keys](int a, int b) {
+        int res = keys[size_t(a)].compare(keys[size_t(b)]);
+        return res ? res < 0 : a < b;
+    });
+    return ranksOf(order, [&keys](int a, int b) { return keys[size_t(a)].compare(keys[size_t(b)]) == 0; });
+}
+
+bool SortEngine::radixSort(std::vector<int> &indices, const SortEngine::Key &key) const
+{
+    size_t count = indices.size();
+    if (count < 2) return !isCanceled();
+    int parts = count < CParallelMin ? 1 : qMax(1, QThread::idealThreadCount());
+    QVector<Chunk> chunks(parts);
+    for (int i = 0; i < parts; ++i) {
+        chunks[i].from = count * size_t(i) / size_t(parts);
+        chunks[i].to = count * size_t(i+1) / size_t(parts);
+    }
+
+    // fetch the keys and find the bytes that differ
+    std::vector<quint64> keys(count);
+    quint64 invert = key.order == Qt::DescendingOrder ? ~quint64(0) : 0;
+    forEachChunk(chunks, [&indices, &keys, &key, invert](Chunk &chunk) {
+        chunk.first = key.func(indices[chunk.from]) ^ invert;
+        for (size_t i = chunk.from; i < chunk.to; ++i) {
+            keys[i] = key.func(indices[i]) ^ invert;
+            chunk.diff |= keys[i] ^ chunk.first;
+        }
+    });
+    quint64 diff = 0;
+    for (const Chunk &chunk : chunks)
+        diff |= chunk.diff | (chunk.first ^ chunks.first().first);
+
+    std::vector<quint64> keysTmp(count);
+    std::vector<int> indicesTmp(count);
+    for (int shift = 0; shift < 64; shift += CDigitBits) {
+        if (!((diff >> shift) & (CDigits-1))) continue;
+        if (isCanceled()) return false;
+        forEachChunk(chunks, [&keys, shift](Chunk &chunk) {
+            memset(chunk.counts, 0, sizeof(chunk.counts));
+            for (size_t i = chunk.from; i < chunk.to; ++i)
+                ++chunk.counts[(keys[i] >> shift) & (CDigits-1)];
+        });
+        // the chunks of a digit follow each other to keep the sort stable
+        size_t pos = 0;
+        for (int digit = 0; digit < CDigits; ++digit) {
+            for (Chunk &chunk : chunks) {
+                size_t digitCount = chunk.counts[digit];
+                chunk.counts[digit] = pos;
+                pos += digitCount;
+            }
+        }
+        forEachChunk(chunks, [&keys, &keysTmp, &indices, &indicesTmp, shift](Chunk &chunk) {
+            for (size_t i = chunk.from; i < chunk.to; ++i) {
+                size_t dest = chunk.counts[(keys[i] >> shift) & (CDigits-1)]++;
+                keysTmp[dest] = keys[i];
+                indicesTmp[dest] = indices[i];
+            }
+        });
+        keys.swap(keysTmp);
+        indices.swap(indicesTmp);
+    }
+    return !isCanceled();
+}
+
+} // namespace studio
+} // namespace gams
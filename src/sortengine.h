@@ -0,0 +1,112 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SORTENGINE_H
+#define SORTENGINE_H
+
+#include <QAtomicInt>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace gams {
+namespace studio {
+
+///
+/// class SortEngine
+/// Sorts index permutations by one or more keys. Each key maps an index to an unsigned 64 bit value, the indices are
+/// ordered by a stable parallel radix sort. The first key added has the highest priority.
+///
+class SortEngine
+{
+public:
+    typedef std::function<quint64(int index)> KeyFunc; // called from several threads at once
+
+    void addKey(KeyFunc key, Qt::SortOrder order = Qt::AscendingOrder);
+    void setCancelFlag(const QAtomicInt *cancel);
+
+    /// Sorts the indices stably by the keys. Returns false and leaves the indices untouched if the sort was canceled.
+    bool sort(std::vector<int> &indices) const;
+
+    static quint64 intKey(qint64 val);
+    static quint64 doubleKey(double val);
+
+    /// Returns the rank of each string, equal strings get the same rank. The strings are ordered by collation keys
+    /// of the current locale if localeAware is set, otherwise by their UTF-16 code units.
+    static std::vector<int> stringRanks(const QStringList &strings, bool localeAware);
+
+    /// Sorts the items by a comparison in parallel: chunks are sorted concurrently and merged pairwise.
+    template<typename Less>
+    static void parallelSort(std::vector<int> &items, Less less);
+
+private:
+    struct Key {
+        KeyFunc func;
+        Qt::SortOrder order;
+    };
+    bool radixSort(std::vector<int> &indices, const Key &key) const;
+    bool isCanceled() const { return mCancel && mCancel->load(); }
+
+    static const size_t CParallelMin = 100000;   // smaller lists are sorted on the calling thread
+
+    QVector<Key> mKeys;
+    const QAtomicInt *mCancel = nullptr;
+};
+
+template<typename Less>
+void SortEngine::parallelSort(std::vector<int> &items, Less less)
+{
+    size_t parts = size_t(qMax(1, QThread::idealThreadCount()));
+    if (parts < 2 || items.size() < CParallelMin) {
+        std::sort(items.begin(), items.end(), less);
+        return;
+    }
+    struct Range {
+        size_t from;
+        size_t mid;
+        size_t to;
+    };
+    QVector<Range> ranges;
+    for (size_t i = 0; i < parts; ++i)
+        ranges << Range {items.size() * i / parts, 0, items.size() * (i+1) / parts};
+    QtConcurrent::blockingMap(ranges, [&items, &less](Range &r) {
+        std::sort(items.begin() + long(r.from), items.begin() + long(r.to), less);
+    });
+    while (ranges.size() > 1) {
+        QVector<Range> merges;
+        for (int i = 0; i + 1 < ranges.size(); i += 2)
+            merges << Range {ranges.at(i).from, ranges.at(i).to, ranges.at(i+1).to};
+        QtConcurrent::blockingMap(merges, [&items, &less](Range &r) {
+            std::inplace_merge(items.begin() + long(r.from), items.begin() + long(r.mid),
+                               items.begin() + long(r.to), less);
+        });
+        if (ranges.size() % 2)
+            merges << ranges.last();
+        ranges = merges;
+    }
+}
+
+} // namespace studio
+} // namespace gams
+
+#endif // SORTENGINE_H
@@ -86,6 +86,7 @@ SOURCES += \
     editors/defaultsystemlogger.cpp \
     editors/editorhelper.cpp \
     editors/filemapper.cpp \
+    editors/linescanner.cpp \
     editors/logparser.cpp \
     editors/memorymapper.cpp \
     editors/processlogedit.cpp \
@@ -117,6 +118,7 @@ SOURCES += \
     gdxdiffdialog/gdxdiffprocess.cpp \
     gdxviewer/columnfilter.cpp \
     gdxviewer/columnfilterframe.cpp \
+    gdxviewer/columnstore.cpp \
     gdxviewer/filteruelmodel.cpp \
     gdxviewer/gdxsymbol.cpp \
     gdxviewer/gdxsymbolheaderview.cpp \
@@ -125,6 +127,10 @@ SOURCES += \
     gdxviewer/gdxviewer.cpp \
     gdxviewer/nestedheaderview.cpp \
     gdxviewer/tableviewmodel.cpp \
+    gdxviewer/uelbitmap.cpp \
+    gdxviewer/uelstore.cpp \
+    gdxviewer/valuefilter.cpp \
+    gdxviewer/valuefilterframe.cpp \
     gotodialog.cpp \
     keys.cpp \
     logger.cpp \
@@ -173,14 +179,18 @@ SOURCES += \
     reference/symbolreferenceitem.cpp \
     reference/symbolreferencewidget.cpp \
     reference/symboltablemodel.cpp \
+    search/literalscanner.cpp \
+    search/replaceworker.cpp \
     search/result.cpp \
     search/resultsview.cpp \
     search/searchdialog.cpp \
     search/searchlocator.cpp \
     search/searchresultlist.cpp \
     search/searchworker.cpp \
+    search/trigramindex.cpp \
     settingsdialog.cpp \
     settingslocator.cpp \
+    sortengine.cpp \
     statuswidgets.cpp \
     studiosettings.cpp \
     support/aboutgamsdialog.cpp         \
@@ -216,6 +226,7 @@ HEADERS += \
     editors/defaultsystemlogger.h \
     editors/editorhelper.h \
     editors/filemapper.h \
+    editors/linescanner.h \
     editors/logparser.h \
     editors/memorymapper.h \
     editors/processlogedit.h \
@@ -248,6 +259,7 @@ HEADERS += \
     gdxdiffdialog/gdxdiffprocess.h \
     gdxviewer/columnfilter.h \
     gdxviewer/columnfilterframe.h \
+    gdxviewer/columnstore.h \
     gdxviewer/filteruelmodel.h \
     gdxviewer/gdxsymbol.h \
     gdxviewer/gdxsymbolheaderview.h \
@@ -256,6 +268,10 @@ HEADERS += \
     gdxviewer/gdxviewer.h \
     gdxviewer/nestedheaderview.h \
     gdxviewer/tableviewmodel.h \
+    gdxviewer/uelbitmap.h \
+    gdxviewer/uelstore.h \
+    gdxviewer/valuefilter.h \
+    gdxviewer/valuefilterframe.h \
     gotodialog.h \
     keys.h \
     logger.h \
@@ -303,14 +319,18 @@ HEADERS += \
     reference/symbolreferenceitem.h \
     reference/symbolreferencewidget.h \
     reference/symboltablemodel.h \
+    search/literalscanner.h \
+    search/replaceworker.h \
     search/result.h \
     search/resultsview.h \
     search/searchdialog.h \
     search/searchlocator.h \
     search/searchresultlist.h \
     search/searchworker.h \
+    search/trigramindex.h \
     settingsdialog.h \
     settingslocator.h \
+    sortengine.h \
     statuswidgets.h \
     studiosettings.h \
     support/aboutgamsdialog.h       \
@@ -341,6 +361,7 @@ FORMS += \
     gdxviewer/columnfilterframe.ui \
     gdxviewer/gdxsymbolview.ui \
     gdxviewer/gdxviewer.ui \
+    gdxviewer/valuefilterframe.ui \
     gotodialog.ui \
     lxiviewer/lxiviewer.ui \
     mainwindow.ui \
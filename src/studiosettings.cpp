@@ -368,6 +368,9 @@ void StudioSettings::loadUserSettings()
     setNrLogBackups(mUserSettings->value("nrLogBackups", 3).toInt());
     setAutoCloseBraces(mUserSettings->value("autoCloseBraces", true).toBool());
     setEditableMaxSizeMB(mUserSettings->value("editableMaxSizeMB", 50).toInt());
+    setLogMemoryBudgetMB(mUserSettings->value("logMemoryBudgetMB", 64).toInt());
+    setSearchIndex(mUserSettings->value("searchIndex", true).toBool());
+    setThreadedHighlighting(mUserSettings->value("threadedHighlighting", true).toBool());
 
     mUserSettings->endGroup();
     mUserSettings->beginGroup("Misc");
@@ -500,6 +503,36 @@ void StudioSettings::setEditableMaxSizeMB(int editableMaxSizeMB)
     mEditableMaxSizeMB = editableMaxSizeMB;
 }
 
+int StudioSettings::logMemoryBudgetMB() const
+{
+    return mLogMemoryBudgetMB;
+}
+
+void StudioSettings::setLogMemoryBudgetMB(int logMemoryBudgetMB)
+{
+    mLogMemoryBudgetMB = logMemoryBudgetMB;
+}
+
+bool StudioSettings::searchIndex() const
+{
+    return mSearchIndex;
+}
+
+void StudioSettings::setSearchIndex(bool searchIndex)
+{
+    mSearchIndex = searchIndex;
+}
+
+bool StudioSettings::threadedHighlighting() const
+{
+    return mThreadedHighlighting;
+}
+
+void StudioSettings::setThreadedHighlighting(bool threadedHighlighting)
+{
+    mThreadedHighlighting = threadedHighlighting;
+}
+
 bool StudioSettings::restoreTabsAndProjects(MainWindow *main)
 {
     bool res = true;
@@ -161,6 +161,15 @@ public:
     int editableMaxSizeMB() const;
     void setEditableMaxSizeMB(int editableMaxSizeMB);
 
+    int logMemoryBudgetMB() const;
+    void setLogMemoryBudgetMB(int logMemoryBudgetMB);
+
+    bool searchIndex() const;
+    void setSearchIndex(bool searchIndex);
+
+    bool threadedHighlighting() const;
+    void setThreadedHighlighting(bool threadedHighlighting);
+
 private:
     QSettings *mAppSettings = nullptr;
     QSettings *mUserSettings = nullptr;
@@ -193,6 +202,9 @@ private:
     int mNrLogBackups;
     bool mAutoCloseBraces;
     int mEditableMaxSizeMB;
+    int mLogMemoryBudgetMB;
+    bool mSearchIndex = true;
+    bool mThreadedHighlighting = true;
 
     // MIRO settings page
     QString mMiroInstallationLocation;
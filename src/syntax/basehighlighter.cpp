@@ -18,13 +18,21 @@
 #include "basehighlighter.h"
 #include "logger.h"
 #include <QTimer>
+#include <QtConcurrent>
 
 namespace gams {
 namespace studio {
 namespace syntax {
 
+static const int CJobBlocks = 1000;         // the number of blocks in a snapshot for the background lexer
+static const int CSyncBlocks = 8;           // edits up to this number of blocks are lexed instantly
+static const int CVisibleMargin = 50;       // the blocks around the visible area that get their formats
+static const int CCheckpointBlocks = 1000;  // lexing the visible blocks starts at latest at this block distance
+static const int CUnlexed = std::numeric_limits<int>::min();
+
 BaseHighlighter::BaseHighlighter(QObject *parent) : QObject(parent)
 {
+    connect(&mJobWatcher, &QFutureWatcher<LexJob>::finished, this, &BaseHighlighter::jobFinished);
     if (parent->inherits("QTextEdit")) {
         QTextDocument *doc = parent->property("document").value<QTextDocument *>();
         if (doc) setDocument(doc);
@@ -33,6 +41,7 @@ BaseHighlighter::BaseHighlighter(QObject *parent) : QObject(parent)
 
 BaseHighlighter::BaseHighlighter(QTextDocument *parent): QObject(parent)
 {
+    connect(&mJobWatcher, &QFutureWatcher<LexJob>::finished, this, &BaseHighlighter::jobFinished);
     setDocument(parent);
 }
 
@@ -40,12 +49,14 @@ BaseHighlighter::~BaseHighlighter()
 {
     mAborted = true;
     mDirtyBlocks.clear();
+    discardJob();
     setDocument(nullptr);
 }
 
 void BaseHighlighter::abortHighlighting()
 {
     mAborted = true;
+    mJobAbort.store(1);
 }
 
 void BaseHighlighter::setDocument(QTextDocument *doc, bool wipe)
@@ -62,15 +73,22 @@ void BaseHighlighter::setDocument(QTextDocument *doc, bool wipe)
             cursor.endEditBlock();
         }
     }
+    discardJob();
     mBlockCount = 1;
     mDoc = doc;
     if (mDoc) {
         connect(mDoc, &QTextDocument::contentsChange, this, &BaseHighlighter::reformatBlocks);
         connect(mDoc, &QTextDocument::blockCountChanged, this, &BaseHighlighter::blockCountChanged);
-        setDirty(mDoc->firstBlock(), mDoc->lastBlock());
-        QTimer::singleShot(0, this, &BaseHighlighter::processDirtyParts);
+        if (mThreaded) {
+            restartThreaded();
+        } else {
+            setDirty(mDoc->firstBlock(), mDoc->lastBlock());
+            QTimer::singleShot(0, this, &BaseHighlighter::processDirtyParts);
+        }
     } else {
         mDirtyBlocks.clear();
+        mResults.clear();
+        mDirtyFrom = -1;
     }
 }
 
@@ -79,9 +97,29 @@ QTextDocument *BaseHighlighter::document() const
     return mDoc;
 }
 
+void BaseHighlighter::setThreaded(bool threaded)
+{
+    if (mThreaded == threaded) return;
+    mThreaded = threaded;
+    discardJob();
+    mDirtyBlocks.clear();
+    mResults.clear();
+    mDirtyFrom = -1;
+    if (mDoc) rehighlight();
+}
+
+bool BaseHighlighter::isThreaded() const
+{
+    return mThreaded;
+}
+
 void BaseHighlighter::rehighlight()
 {
     if (!mDoc) return;
+    if (mThreaded) {
+        restartThreaded();
+        return;
+    }
     setDirty(mDoc->firstBlock(), mDoc->lastBlock());
     processDirtyParts();
 }
@@ -89,6 +127,10 @@ void BaseHighlighter::rehighlight()
 void BaseHighlighter::rehighlightBlock(const QTextBlock &block)
 {
     if (!mDoc || !block.isValid()) return;
+    if (mThreaded) {
+        rehighlightThreaded(block);
+        return;
+    }
     mCurrentBlock = block;
     bool forceHighlightOfNextBlock = true;
     if (mTime.isNull()) mTime = QTime::currentTime();
@@ -117,6 +159,10 @@ void BaseHighlighter::rehighlightBlock(const QTextBlock &block)
 void BaseHighlighter::reformatBlocks(int from, int charsRemoved, int charsAdded)
 {
     if (!mDoc) return;
+    if (mThreaded) {
+        reformatThreaded(from, charsRemoved, charsAdded);
+        return;
+    }
     QTextBlock fromBlock = mDoc->findBlock(from);
     if (!fromBlock.isValid())
         return;
@@ -140,7 +186,7 @@ QTextBlock cutEnd(QTextBlock block, int altLine, QTextDocument *doc)
 
 void BaseHighlighter::blockCountChanged(int newBlockCount)
 {
-    if (!mDoc) return;
+    if (!mDoc || mThreaded) return;
     for (int i = 0; i < mDirtyBlocks.size(); ++i) {
         mDirtyBlocks[i].setFirst(cutEnd(mDirtyBlocks.at(i).bFirst, mDirtyBlocks.at(i).first, mDoc));
         mDirtyBlocks[i].setSecond(cutEnd(mDirtyBlocks.at(i).bSecond, mDirtyBlocks.at(i).second, mDoc));
@@ -247,6 +293,28 @@ void BaseHighlighter::applyFormatChanges()
         formatsChanged = true;
     }
 
+    for (QTextLayout::FormatRange r : formatRanges()) {
+        if (preeditAreaLength != 0) {
+            if (r.start >= preeditAreaStart)
+                r.start += preeditAreaLength;
+            else if (r.start + r.length >= preeditAreaStart)
+                r.length += preeditAreaLength;
+        }
+
+        ranges << r;
+        formatsChanged = true;
+    }
+
+    if (formatsChanged) {
+        layout->setFormats(ranges);
+        mDoc->markContentsDirty(mCurrentBlock.position(), mCurrentBlock.length());
+    }
+
+}
+
+QVector<QTextLayout::FormatRange> BaseHighlighter::formatRanges() const
+{
+    QVector<QTextLayout::FormatRange> ranges;
     int i = 0;
     while (i < mFormatChanges.count()) {
         QTextLayout::FormatRange r;
@@ -265,23 +333,9 @@ void BaseHighlighter::applyFormatChanges()
 
         Q_ASSERT(i <= mFormatChanges.count());
         r.length = i - r.start;
-
-        if (preeditAreaLength != 0) {
-            if (r.start >= preeditAreaStart)
-                r.start += preeditAreaLength;
-            else if (r.start + r.length >= preeditAreaStart)
-                r.length += preeditAreaLength;
-        }
-
         ranges << r;
-        formatsChanged = true;
-    }
-
-    if (formatsChanged) {
-        layout->setFormats(ranges);
-        mDoc->markContentsDirty(mCurrentBlock.position(), mCurrentBlock.length());
     }
-
+    return ranges;
 }
 
 QTextBlock BaseHighlighter::nextDirty()
@@ -338,6 +392,282 @@ void BaseHighlighter::setClean(QTextBlock block)
     }
 }
 
+void BaseHighlighter::restartThreaded()
+{
+    discardJob();
+    mDirtyBlocks.clear();
+    mResults.clear();
+    mDirtyFrom = -1;
+    if (!mDoc) return;
+    mResults.resize(mDoc->blockCount());
+    markThreadedDirty(0);
+    startJob();
+}
+
+void BaseHighlighter::reformatThreaded(int from, int charsRemoved, int charsAdded)
+{
+    QTextBlock fromBlock = mDoc->findBlock(from);
+    if (!fromBlock.isValid())
+        return;
+    QTextBlock lastBlock = mDoc->findBlock(from + charsAdded + (charsRemoved > 0 ? 1 : 0));
+    if (!lastBlock.isValid())
+        lastBlock = mDoc->lastBlock();
+    int first = fromBlock.blockNumber();
+    int last = lastBlock.blockNumber();
+
+    // keep the results of the unchanged blocks at their block number
+    int delta = mDoc->blockCount() - mResults.size();
+    if (delta > 0 && first < mResults.size())
+        mResults.insert(first + 1, delta, BlockResult());
+    else if (delta < 0 && first + 1 - delta <= mResults.size())
+        mResults.remove(first + 1, -delta);
+    if (mResults.size() != mDoc->blockCount()) {
+        restartThreaded();
+        return;
+    }
+    if (delta && mDirtyFrom > first) mDirtyFrom = qMax(first, mDirtyFrom + delta);
+    for (int nr = first; nr <= last; ++nr)
+        mResults[nr].lexed = false;
+
+    if (!mJobRunning && mDirtyFrom < 0 && last - first < CSyncBlocks) {
+        // a small edit: lex instantly and only continue in the background if the state at the end changed
+        const int stateBeforeHighlight = lastBlock.userState();
+        QMutexLocker locker(&mLexMutex);
+        for (QTextBlock block = fromBlock; block.isValid(); block = block.next()) {
+            mCurrentBlock = block;
+            reformatCurrentBlock();
+            mResults[block.blockNumber()] = BlockResult(true);
+            if (block == lastBlock) break;
+        }
+        mFormatChanges.clear();
+        if (lastBlock.userState() == stateBeforeHighlight || !lastBlock.next().isValid())
+            return;
+        first = last + 1;
+    }
+    markThreadedDirty(first);
+    startJob();
+}
+
+bool BaseHighlighter::rehighlightThreaded(QTextBlock block)
+{
+    const int stateBeforeHighlight = block.userState();
+    int nr = block.blockNumber();
+    if (!mLexMutex.tryLock()) {
+        // the background lexer is busy with a job, the block is lexed by the next one
+        if (nr < mResults.size()) mResults[nr].lexed = false;
+        markThreadedDirty(nr);
+        return false;
+    }
+    mCurrentBlock = block;
+    reformatCurrentBlock();
+    mFormatChanges.clear();
+    mLexMutex.unlock();
+    if (nr < mResults.size()) mResults[nr] = BlockResult(true);
+    if (block.userState() != stateBeforeHighlight && block.next().isValid()) {
+        if (nr + 1 < mResults.size()) mResults[nr + 1].lexed = false;
+        markThreadedDirty(nr + 1);
+        startJob();
+    }
+    return true;
+}
+
+bool BaseHighlighter::lexBlock(const QTextBlock &block)
+{
+    if (!mDoc || !block.isValid()) return false;
+    if (mThreaded) return rehighlightThreaded(block);
+    rehighlightBlock(block);
+    return true;
+}
+
+QTextCharFormat BaseHighlighter::lexedFormat(const QTextBlock &block, int posInBlock) const
+{
+    if (!block.isValid()) return QTextCharFormat();
+    int nr = block.blockNumber();
+    const QVector<QTextLayout::FormatRange> formats = (nr >= 0 && nr < mResults.size() && !mResults.at(nr).applied)
+            ? mResults.at(nr).formats : block.layout()->formats();
+    for (const QTextLayout::FormatRange &range : formats) {
+        if (posInBlock >= range.start && posInBlock < range.start + range.length)
+            return range.format;
+    }
+    return QTextCharFormat();
+}
+
+void BaseHighlighter::markThreadedDirty(int fromNr)
+{
+    mDirtyFrom = mDirtyFrom < 0 ? fromNr : qMin(mDirtyFrom, fromNr);
+    // results of the running job from this block on are outdated
+    if (mJobRunning) mEditFloor = qMin(mEditFloor, fromNr);
+}
+
+int BaseHighlighter::nextUnlexed(int fromNr) const
+{
+    for (int nr = fromNr; nr < mResults.size(); ++nr) {
+        if (!mResults.at(nr).lexed) return nr;
+    }
+    return -1;
+}
+
+bool BaseHighlighter::prepareViewportJob(LexJob &job, int &count) const
+{
+    for (const QPair<int,int> &range : mVisibleBlocks) {
+        int to = qMin(mResults.size() - 1, range.second + CVisibleMargin);
+        int nr = qMax(0, range.first - CVisibleMargin);
+        while (nr <= to && mResults.at(nr).lexed)
+            ++nr;
+        if (nr > to) continue;
+        // resume behind the last lexed block, but not before the checkpoint
+        int checkpoint = (nr / CCheckpointBlocks) * CCheckpointBlocks;
+        while (nr > checkpoint && !mResults.at(nr - 1).lexed)
+            --nr;
+        // the regular job continues here anyway
+        if (mDirtyFrom >= 0 && nr <= mDirtyFrom) continue;
+        job.from = nr;
+        job.speculative = true;
+        count = to - nr + 1;
+        return true;
+    }
+    return false;
+}
+
+void BaseHighlighter::startJob()
+{
+    if (!mDoc || mAborted || mJobRunning) return;
+    LexJob job;
+    int count = CJobBlocks;
+    if (!prepareViewportJob(job, count)) {
+        if (mDirtyFrom < 0) return;
+        if (mDirtyFrom >= mResults.size()) {
+            mDirtyFrom = -1;
+            return;
+        }
+        job.from = mDirtyFrom;
+    }
+    QTextBlock block = mDoc->findBlockByNumber(job.from);
+    if (!block.isValid()) return;
+    // a speculative job that starts on an unknown state assumes the top level at its checkpoint
+    if (job.from > 0 && (!job.speculative || mResults.at(job.from - 1).lexed))
+        job.previousState = block.previous().userState();
+    job.texts.reserve(count);
+    job.oldStates.reserve(count);
+    for (int i = 0; i < count && block.isValid(); ++i) {
+        job.texts << block.text();
+        job.oldStates << (mResults.at(job.from + i).lexed ? block.userState() : CUnlexed);
+        block = block.next();
+    }
+    mEditFloor = std::numeric_limits<int>::max();
+    mJobRunning = true;
+    mJobWatcher.setFuture(QtConcurrent::run(this, &BaseHighlighter::runJob, job));
+}
+
+BaseHighlighter::LexJob BaseHighlighter::runJob(LexJob job)
+{
+    QMutexLocker locker(&mLexMutex);
+    job.results.reserve(job.texts.size());
+    job.data.reserve(job.texts.size());
+    int state = job.previousState;
+    for (int i = 0; i < job.texts.size(); ++i) {
+        if (mJobAbort.load()) break;
+        const QString &text = job.texts.at(i);
+        mFormatChanges.fill(QTextCharFormat(), text.length());
+        QTextBlockUserData *data = nullptr;
+        state = highlightText(text, state, data);
+        BlockResult result(true);
+        result.state = state;
+        result.applied = false;
+        result.formats = formatRanges();
+        job.results << result;
+        job.data << data;
+        if (!job.speculative && state == job.oldStates.at(i)) {
+            job.converged = true;
+            break;
+        }
+    }
+    mFormatChanges.clear();
+    job.texts.clear();
+    return job;
+}
+
+void BaseHighlighter::jobFinished()
+{
+    if (!mJobRunning) return;
+    mJobRunning = false;
+    LexJob job = mJobWatcher.result();
+    int accepted = qBound(0, mEditFloor - job.from, job.results.size());
+    QTextBlock block = mDoc ? mDoc->findBlockByNumber(job.from) : QTextBlock();
+    for (int i = 0; i < job.results.size(); ++i) {
+        int nr = job.from + i;
+        if (i >= accepted || !block.isValid() || nr >= mResults.size()) {
+            delete job.data.at(i);
+            continue;
+        }
+        block.setUserState(job.results.at(i).state);
+        block.setUserData(job.data.at(i));
+        mResults[nr] = job.results.at(i);
+        block = block.next();
+    }
+    int next = mDirtyFrom;
+    int end = job.from + accepted;
+    if (job.speculative) {
+        // a following block that has been lexed on another state has to be lexed again
+        if (accepted > 0 && end < mResults.size() && job.results.at(accepted-1).state != job.oldStates.at(accepted-1)) {
+            mResults[end].lexed = false;
+            if (next < 0) next = end;
+        }
+    } else {
+        next = (job.converged && accepted == job.results.size()) ? nextUnlexed(end) : end;
+    }
+    if (mEditFloor < std::numeric_limits<int>::max())
+        next = next < 0 ? mEditFloor : qMin(next, mEditFloor);
+    mEditFloor = std::numeric_limits<int>::max();
+    mDirtyFrom = next;
+    applyVisible();
+    startJob();
+}
+
+void BaseHighlighter::discardJob()
+{
+    if (!mJobRunning) return;
+    mJobAbort.store(1);
+    mJobWatcher.waitForFinished();
+    for (QTextBlockUserData *data : mJobWatcher.result().data)
+        delete data;
+    mJobRunning = false;
+    mJobAbort.store(mAborted ? 1 : 0);
+}
+
+void BaseHighlighter::setVisibleBlocks(int firstBlockNr, int lastBlockNr)
+{
+    mVisibleBlocks.insert(sender(), qMakePair(firstBlockNr, lastBlockNr));
+    if (!mThreaded) return;
+    applyVisible();
+    startJob();
+}
+
+void BaseHighlighter::removeVisibleBlocks(QObject *editor)
+{
+    mVisibleBlocks.remove(editor);
+}
+
+void BaseHighlighter::applyVisible()
+{
+    if (!mDoc) return;
+    for (const QPair<int,int> &range : mVisibleBlocks) {
+        int from = qMax(0, range.first - CVisibleMargin);
+        int to = qMin(mResults.size() - 1, range.second + CVisibleMargin);
+        QTextBlock block = mDoc->findBlockByNumber(from);
+        for (int nr = from; nr <= to && block.isValid(); ++nr) {
+            BlockResult &result = mResults[nr];
+            if (!result.applied) {
+                block.layout()->setFormats(result.formats);
+                mDoc->markContentsDirty(block.position(), block.length());
+                result.applied = true;
+                result.formats = QVector<QTextLayout::FormatRange>();
+            }
+            block = block.next();
+        }
+    }
+}
+
 BaseHighlighter::Interval::Interval(QTextBlock firstBlock, QTextBlock secondBlock)
     : QPair<int,int>(0,0)
 {
@@ -22,8 +22,14 @@
 #include <QTextDocument>
 #include <QTextCharFormat>
 #include <QTextObject>
+#include <QTextLayout>
 #include <QVector>
 #include <QTime>
+#include <QHash>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <limits>
 
 namespace gams {
 namespace studio {
@@ -41,17 +47,30 @@ public:
     void setDocument(QTextDocument *doc, bool wipe = false);
     QTextDocument *document() const;
 
+    /// In threaded mode the blocks are lexed on a snapshot of their text in a background thread. The states and user
+    /// data are handed over to the document when a job is done, the formats are applied only to visible blocks.
+    /// Visible blocks that haven't been lexed yet are lexed first, starting at latest at the preceding checkpoint.
+    void setThreaded(bool threaded);
+    bool isThreaded() const;
+    /// Forgets the visible blocks reported by the editor, to be called when the editor is detached.
+    void removeVisibleBlocks(QObject *editor);
+
 public slots:
     void rehighlight();
     void rehighlightBlock(const QTextBlock &startBlock);
+    void setVisibleBlocks(int firstBlockNr, int lastBlockNr);
 
 private slots:
     void reformatBlocks(int from, int charsRemoved, int charsAdded);
     void blockCountChanged(int newBlockCount);
     void processDirtyParts();
+    void jobFinished();
 
 protected:
     virtual void highlightBlock(const QString &text) = 0;
+    /// Lexes the text of a block without access to the document, the formats are collected by setFormat. Returns the
+    /// state of the block and sets the user data (or nullptr). Called by the background thread in threaded mode.
+    virtual int highlightText(const QString &text, int previousState, QTextBlockUserData *&data) = 0;
     void setFormat(int start, int count, const QTextCharFormat &format);
     QTextCharFormat format(int pos) const;
 
@@ -64,9 +83,16 @@ protected:
 
     QTextBlock currentBlock() const;
 
+    /// Lexes the block at once. In threaded mode the GUI thread never waits for the background lexer: if it is busy
+    /// the block is left to the next job and false is returned.
+    bool lexBlock(const QTextBlock &block);
+    /// Returns the format at the position in the block from the last lexer result, also if it isn't applied yet.
+    QTextCharFormat lexedFormat(const QTextBlock &block, int posInBlock) const;
+
 private:
     void reformatCurrentBlock();
     void applyFormatChanges();
+    QVector<QTextLayout::FormatRange> formatRanges() const;
     QTextBlock nextDirty();
     void setDirty(QTextBlock fromBlock, QTextBlock toBlock);
     void setClean(QTextBlock block);
@@ -109,6 +135,36 @@ private:
         QTextBlock bSecond; // backup for changes
     };
 
+    struct BlockResult {
+        explicit BlockResult(bool isLexed = false) : lexed(isLexed) {}
+        bool lexed;                                 // the block has been lexed based on the state of its predecessor
+        int state = -1;
+        bool applied = true;                        // the formats have been set to the layout of the block
+        QVector<QTextLayout::FormatRange> formats;  // kept until the block gets visible
+    };
+
+    struct LexJob {
+        int from = 0;                               // the block number of the first text
+        bool speculative = false;                   // lexes the visible blocks ahead of the regular job
+        int previousState = -1;
+        QStringList texts;                          // the snapshot of the blocks
+        QVector<int> oldStates;
+        QVector<BlockResult> results;
+        QVector<QTextBlockUserData*> data;
+        bool converged = false;                     // the regular job ended on an unchanged state
+    };
+
+    void restartThreaded();
+    void reformatThreaded(int from, int charsRemoved, int charsAdded);
+    bool rehighlightThreaded(QTextBlock block);
+    void markThreadedDirty(int fromNr);
+    int nextUnlexed(int fromNr) const;
+    bool prepareViewportJob(LexJob &job, int &count) const;
+    void startJob();
+    LexJob runJob(LexJob job);
+    void discardJob();
+    void applyVisible();
+
 //    class BInterval : public QPair<QTextBlock, QTextBlock>  {
 //    public:
 //        BInterval(QTextBlock first = QTextBlock(), QTextBlock second = QTextBlock())
@@ -129,6 +185,16 @@ private:
     QVector<Interval> mDirtyBlocks;             // disjoint regions of dirty blocks
     QVector<QTextCharFormat> mFormatChanges;
 
+    bool mThreaded = false;
+    QMutex mLexMutex;                           // the lexer is used by one thread at a time
+    QAtomicInt mJobAbort;
+    QFutureWatcher<LexJob> mJobWatcher;
+    bool mJobRunning = false;
+    QVector<BlockResult> mResults;              // the results of the background lexer per block number
+    int mDirtyFrom = -1;                        // the regular job continues here, all blocks before are valid
+    int mEditFloor = std::numeric_limits<int>::max();   // the first block changed while a job is running
+    QHash<QObject*, QPair<int,int>> mVisibleBlocks;
+
 };
 
 } // namespace syntax
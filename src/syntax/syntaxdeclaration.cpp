@@ -31,17 +31,70 @@ bool cmpStr(const QPair<QString, QString>& lhs,const QPair<QString, QString>& rh
     return lhs.first.compare(rhs.first, Qt::CaseInsensitive) < 0;
 }
 
-DictList::DictList(QList<QPair<QString, QString> > list) : mEntries(QVector<DictEntry*>(list.size())), mEqualStart(QVector<int>(list.size()))
+DictList::DictList(QList<QPair<QString, QString> > list) : mCount(list.size())
 {
     std::sort(list.begin(), list.end(), cmpStr);
-    QString prevS;
-    mEntries.reserve(list.size());
-    mEqualStart.reserve(list.size());
+    std::fill(mAsciiColumn, mAsciiColumn + 128, -1);
+    for (const QPair<QString, QString> &entry : list) {
+        for (const QChar &c : entry.first)
+            addColumn(c);
+    }
+
+    // the root node 0 is the empty prefix
+    mNext.fill(0, mColumnCount);
+    mKeyOfNode << -1;
     for (int i = 0; i < list.size(); ++i) {
-        const QString &s(list.at(i).first);
-        mEntries[i] = new DictEntry(s);
-        mEqualStart[i] = equalStart(s, prevS);
-        prevS = s;
+        int node = 0;
+        for (const QChar &c : list.at(i).first) {
+            int cell = node * mColumnCount + column(c);
+            if (!mNext.at(cell)) {
+                mNext[cell] = mKeyOfNode.size();
+                mKeyOfNode << -1;
+                mNext.resize(mNext.size() + mColumnCount);
+            }
+            node = mNext.at(cell);
+        }
+        // on duplicates the first keyword is taken
+        if (mKeyOfNode.at(node) < 0) mKeyOfNode[node] = i;
+    }
+    mNext.squeeze();
+    mKeyOfNode.squeeze();
+}
+
+int DictList::addColumn(QChar c)
+{
+    int col = column(c);
+    if (col >= 0) return col;
+    col = mColumnCount++;
+    QChar folded = c.toCaseFolded();
+    if (folded.unicode() < 128) {
+        mAsciiColumn[folded.unicode()] = col;
+        mAsciiColumn[folded.toUpper().unicode()] = col;
+    } else {
+        mWideColumn.insert(folded, col);
+    }
+    return col;
+}
+
+int DictList::match(const QString &line, int index, int &iKey, bool openEnd) const
+{
+    iKey = -1;
+    int node = 0;
+    for (int i = index; ; ++i) {
+        if (i >= line.length() || !isKeywordChar(line.at(i))) {
+            // reached the end of the identifier
+            iKey = mKeyOfNode.at(node);
+            return iKey < 0 ? -1 : i;
+        }
+        if (openEnd && mKeyOfNode.at(node) >= 0) {
+            // a keyword starts the identifier
+            iKey = mKeyOfNode.at(node);
+            return i;
+        }
+        int col = column(line.at(i));
+        if (col < 0) return -1;
+        node = mNext.at(node * mColumnCount + col);
+        if (!node) return -1;
     }
 }
 
@@ -74,27 +127,12 @@ QStringList SyntaxKeywordBase::swapStringCase(QStringList list)
 
 int SyntaxKeywordBase::findEnd(SyntaxKind kind, const QString& line, int index, int &iKey, bool openEnd)
 {
-    iKey = 0;
-    int iChar = 0;
-    while (true) {
-        const DictEntry *dEntry = &mKeywords.value(int(kind))->at(iKey);
-        if (iChar+index >= line.length() || !isKeywordChar(line.at(iChar+index))) {
-            if (dEntry->length() > iChar) return -1;
-            return iChar+index; // reached an valid end
-        } else if (iChar < dEntry->length() &&  dEntry->is(line.at(iChar+index), iChar) ) {
-            // character equals
-            iChar++;
-        } else if (openEnd && iChar == dEntry->length()) {
-            return iChar+index; // reached an valid end of keyword-start
-        } else {
-            // different character  at iChar: switch to next keyword
-            iKey++;
-            if (iKey >= mKeywords.value(int(kind))->count()) break; // no more keywords
-            // next keyword starts with less equal characters than already matched
-            if (mKeywords.value(int(kind))->equalToPrevious(iKey) < iChar) break;
-        }
+    const DictList *keywords = mKeywords.value(int(kind));
+    if (!keywords) {
+        iKey = -1;
+        return -1;
     }
-    return -1;
+    return keywords->match(line, index, iKey, openEnd);
 }
 
 
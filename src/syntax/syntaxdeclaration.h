@@ -26,41 +26,35 @@ namespace gams {
 namespace studio {
 namespace syntax {
 
-class DictEntry
-{
-public:
-    DictEntry(QString entry): mEntry(entry)
-    {
-        for (int i = 0; i < entry.length(); ++i) {
-            mInvertCase += entry.at(i).isLower() ? entry.at(i).toUpper() : entry.at(i).toLower();
-        }
-    }
-    virtual ~DictEntry() {}
-    inline bool is(const QChar &c, int i) const {
-        return mEntry.at(i) == c || mInvertCase.at(i) == c;
-    }
-    inline int length() const { return mEntry.length(); }
-private:
-    QString mEntry;
-    QString mInvertCase;
-};
-
+///
+/// class DictList
+/// A list of keywords compiled into a case-insensitive transition table. Each node stands for a keyword prefix, the
+/// columns are the case-folded characters used by the keywords.
+///
 class DictList
 {
 public:
     DictList(QList<QPair<QString, QString>> list);
-    virtual ~DictList() { while (!mEntries.isEmpty()) delete mEntries.takeFirst(); }
-    inline int equalToPrevious(int i) const { return mEqualStart.at(i); }
-    inline const DictEntry &at(int i) const { return *mEntries.at(i); }
-    inline int count() const { return mEntries.length(); }
+    virtual ~DictList() {}
+    inline int count() const { return mCount; }
+
+    /// Matches the identifier at index against the keywords in a single pass. Returns the end of the match or -1 and
+    /// sets iKey to the index of the keyword in the sorted list. With openEnd the shortest keyword that starts the
+    /// identifier matches.
+    int match(const QString &line, int index, int &iKey, bool openEnd = false) const;
+
 private:
-    inline int equalStart(const QString &pre, const QString &post) const {
-        int res = 0;
-        while (res<pre.length() && res<post.length() && pre.at(res).toUpper() == post.at(res).toUpper()) res++;
-        return res;
+    inline int column(const QChar &c) const {
+        return c.unicode() < 128 ? mAsciiColumn[c.unicode()] : mWideColumn.value(c.toCaseFolded(), -1);
     }
-    QVector<DictEntry*> mEntries;
-    QVector<int> mEqualStart;
+    int addColumn(QChar c);
+
+    int mCount;
+    int mColumnCount = 0;
+    int mAsciiColumn[128];
+    QHash<QChar, int> mWideColumn;
+    QVector<int> mNext;                 // [node * mColumnCount + column]: the next node, 0 if there is none
+    QVector<int> mKeyOfNode;            // the index of the keyword ending at the node or -1
 };
 
 
@@ -95,6 +95,12 @@ Q_ENUM_NS(SyntaxKind);
 
 QString syntaxKindName(SyntaxKind kind);
 
+/// Returns true if the character can be part of a keyword or an identifier.
+inline bool isKeywordChar(const QChar &ch)
+{
+    return ch.isLetterOrNumber() || ch == '_' || ch == '.';
+}
+
 enum class SyntaxShift {
     shift,      ///> replace current-top-kind by this
     skip,       ///> skips this kind (keep current-top-kind)
@@ -178,12 +184,11 @@ protected:
 
 
     inline bool isKeywordChar(const QChar& ch) {
-        return (ch.isLetterOrNumber() || ch == '_' || ch == '.');
+        return syntax::isKeywordChar(ch);
     }
     inline bool isKeywordChar(const QString& line, int index) {
         if (index >= line.length()) return false;
-        const QChar& ch(line.at(index));
-        return (ch.isLetterOrNumber() || ch == '_' || ch == '.');
+        return syntax::isKeywordChar(line.at(index));
     }
     inline bool isWhitechar(const QString& line, int index) {
         if (index >= line.length()) return false;
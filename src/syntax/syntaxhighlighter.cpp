@@ -140,6 +140,7 @@ SyntaxHighlighter::SyntaxHighlighter(QTextDocument* doc)
 
 SyntaxHighlighter::~SyntaxHighlighter()
 {
+    setDocument(nullptr); // waits for a running background job that uses the kinds
     while (!mKinds.isEmpty()) {
         delete mKinds.takeFirst();
     }
@@ -149,12 +150,48 @@ void SyntaxHighlighter::highlightBlock(const QString& text)
 {
     QVector<ParenthesesPos> parPosList;
     parPosList.reserve(20);
-    BlockCode code = previousBlockState();
-    if (!code.isValid()) code = 0;
-    int index = 0;
     QTextBlock textBlock = currentBlock();
     int posForSyntaxKind = mPositionForSyntaxKind - textBlock.position();
     if (posForSyntaxKind < 0) posForSyntaxKind = text.length();
+    int state = scanText(text, previousBlockState(), posForSyntaxKind, parPosList);
+
+    // update BlockData
+    if (!parPosList.isEmpty() || textBlock.userData()) {
+        parPosList.squeeze();
+        BlockData* blockData = textBlock.userData() ? static_cast<BlockData*>(textBlock.userData()) : nullptr;
+        if (!parPosList.isEmpty() && !blockData) {
+            blockData = new BlockData();
+        }
+        if (blockData) blockData->setParentheses(parPosList);
+        if (blockData && blockData->isEmpty())
+            textBlock.setUserData(nullptr);
+        else
+            textBlock.setUserData(blockData);
+    }
+    setCurrentBlockState(state);
+}
+
+int SyntaxHighlighter::highlightText(const QString &text, int previousState, QTextBlockUserData *&data)
+{
+    QVector<ParenthesesPos> parPosList;
+    // the position for the syntax kind is behind the text, so the request of the GUI thread isn't touched
+    int state = scanText(text, previousState, text.length() + 1, parPosList);
+    data = nullptr;
+    if (!parPosList.isEmpty()) {
+        parPosList.squeeze();
+        BlockData* blockData = new BlockData();
+        blockData->setParentheses(parPosList);
+        data = blockData;
+    }
+    return state;
+}
+
+int SyntaxHighlighter::scanText(const QString &text, int previousState, int posForSyntaxKind,
+                                QVector<ParenthesesPos> &parPosList)
+{
+    BlockCode code = previousState;
+    if (!code.isValid()) code = 0;
+    int index = 0;
     bool emptyLineKinds = true;
 //    DEB() << text;
 
@@ -229,29 +266,22 @@ void SyntaxHighlighter::highlightBlock(const QString& text)
             posForSyntaxKind = text.length()+1;
         }
     }
-    // update BlockData
-    if (!parPosList.isEmpty() || textBlock.userData()) {
-        parPosList.squeeze();
-        BlockData* blockData = textBlock.userData() ? static_cast<BlockData*>(textBlock.userData()) : nullptr;
-        if (!parPosList.isEmpty() && !blockData) {
-            blockData = new BlockData();
-        }
-        if (blockData) blockData->setParentheses(parPosList);
-        if (blockData && blockData->isEmpty())
-            textBlock.setUserData(nullptr);
-        else
-            textBlock.setUserData(blockData);
-    }
-    setCurrentBlockState(purgeCode(code.code()));
 //    DEB() << text << "      _" << codeDeb(code.code());
+    return purgeCode(code.code());
 }
 
 void SyntaxHighlighter::syntaxKind(int position, int &intKind)
 {
+    QTextBlock block = document()->findBlock(position);
     mPositionForSyntaxKind = position;
     mLastSyntaxKind = 0;
-    rehighlightBlock(document()->findBlock(position));
-    intKind = mLastSyntaxKind;
+    if (lexBlock(block)) {
+        intKind = mLastSyntaxKind;
+    } else {
+        // while the background lexer is busy the kind is taken from the formats of its last result
+        intKind = lexedFormat(block, position - block.position()).property(QTextFormat::UserProperty).toInt();
+    }
+    mPositionForSyntaxKind = -1;
     mLastSyntaxKind = 0;
 }
 
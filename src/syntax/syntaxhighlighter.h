@@ -47,7 +47,13 @@ public:
 public slots:
     void syntaxKind(int position, int &intKind);
 
+protected:
+    int highlightText(const QString &text, int previousState, QTextBlockUserData *&data) override;
+
 private:
+    /// Scans the text starting with the state of the previous block, sets the formats and collects the parentheses.
+    /// Returns the state at the end of the text.
+    int scanText(const QString &text, int previousState, int posForSyntaxKind, QVector<ParenthesesPos> &parPosList);
     SyntaxAbstract *getSyntax(SyntaxKind kind) const;
     int getKindIdx(SyntaxKind kind) const;
     void scanParentheses(const QString &text, int start, int len, SyntaxKind preKind, SyntaxKind kind,SyntaxKind postKind, QVector<ParenthesesPos> &parentheses);
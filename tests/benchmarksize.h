@@ -0,0 +1,36 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BENCHMARKSIZE_H
+#define BENCHMARKSIZE_H
+
+#include <QtGlobal>
+
+///
+/// Returns the size of the data of a benchmark. The default keeps a test run short, the environment variable can
+/// set the size of a real measurement, e.g. STUDIO_LINESCANNER_MB=1024 or STUDIO_SORT_COUNT=20000000.
+///
+inline qint64 benchmarkSize(const char *env, qint64 defaultValue)
+{
+    bool ok;
+    qint64 size = qgetenv(env).toLongLong(&ok);
+    return (ok && size > 0) ? size : defaultValue;
+}
+
+#endif // BENCHMARKSIZE_H
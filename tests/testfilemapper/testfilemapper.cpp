@@ -24,10 +24,28 @@
 #include <QStandardPaths>
 #include <QClipboard>
 #include <QApplication>
+#include <QDateTime>
+#include <QFileInfo>
 
 using gams::studio::FileMapper;
 
 const QString testFileName("testtextmapper.tmp");
+const QString testIndexFileName("testlineindex.tmp");
+
+static void setModified(const QString &fileName, const QDateTime &time)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QFile::ReadWrite));
+    QVERIFY(file.setFileTime(time, QFileDevice::FileModificationTime));
+}
+
+static void patchByte(const QString &fileName, qint64 pos, char c)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QFile::ReadWrite));
+    QVERIFY(file.seek(pos));
+    QCOMPARE(file.write(&c, 1), 1LL);
+}
 
 void TestFileMapper::initTestCase()
 {
@@ -251,5 +269,72 @@ void TestFileMapper::testPosAndAnchor()
     QCOMPARE(mMapper->position(true).y(), 10);
 }
 
+void TestFileMapper::testLineIndex()
+{
+    // the line index is kept for files of at least 32 MB
+    QStandardPaths::setTestModeEnabled(true);
+    QDir indexDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/lineindex");
+    indexDir.removeRecursively();
+    QString fileName = mCurrentPath.absoluteFilePath(testIndexFileName);
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QFile::WriteOnly));
+        const QByteArray line("This is a line of the line index test file with some additional characters.\n");
+        for (qint64 size = 0; size < 34*1024*1024; size += line.size())
+            file.write(line);
+    }
+    QDateTime modified = QFileInfo(fileName).lastModified();
+    qint64 size = QFileInfo(fileName).size();
+
+    // the first opening indexes the file in the background and writes the index
+    int lines = 0;
+    {
+        FileMapper mapper;
+        QVERIFY(mapper.openFile(fileName, true));
+        QTRY_VERIFY_WITH_TIMEOUT(!indexDir.entryList(QStringList() << "*.idx", QDir::Files).isEmpty(), 20000);
+        lines = mapper.knownLineNrs();
+        QVERIFY(lines > 0);
+    }
+    // a valid index provides all line numbers instantly
+    {
+        FileMapper mapper;
+        QVERIFY(mapper.openFile(fileName, true));
+        QCOMPARE(mapper.knownLineNrs(), lines);
+    }
+    // a changed modification time invalidates the index
+    setModified(fileName, modified.addSecs(10));
+    {
+        FileMapper mapper;
+        QVERIFY(mapper.openFile(fileName, true));
+        QVERIFY(mapper.knownLineNrs() < lines);
+    }
+    // changed content at the head or the tail invalidates the index, even with the same size and time
+    patchByte(fileName, 0, 't');
+    setModified(fileName, modified);
+    {
+        FileMapper mapper;
+        QVERIFY(mapper.openFile(fileName, true));
+        QVERIFY(mapper.knownLineNrs() < lines);
+    }
+    patchByte(fileName, 0, 'T');
+    patchByte(fileName, size-2, ',');
+    setModified(fileName, modified);
+    {
+        FileMapper mapper;
+        QVERIFY(mapper.openFile(fileName, true));
+        QVERIFY(mapper.knownLineNrs() < lines);
+    }
+    // restoring the content makes the index valid again
+    patchByte(fileName, size-2, '.');
+    setModified(fileName, modified);
+    {
+        FileMapper mapper;
+        QVERIFY(mapper.openFile(fileName, true));
+        QCOMPARE(mapper.knownLineNrs(), lines);
+    }
+
+    QFile::remove(fileName);
+    indexDir.removeRecursively();
+}
 
 QTEST_MAIN(TestFileMapper)
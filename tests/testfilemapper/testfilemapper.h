@@ -45,6 +45,7 @@ private slots:
     void testPeekChunkLineNrs();
     void testLineNrEstimation();
     void testPosAndAnchor();
+    void testLineIndex();
 
 private:
     FileMapper *mMapper;
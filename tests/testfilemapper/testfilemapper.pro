@@ -22,17 +22,21 @@ TEMPLATE = app
 
 include(../tests.pri)
 
+QT += concurrent
+
 INCLUDEPATH += $$SRCPATH \
                $$SRCPATH/editors
 
 HEADERS += \
     $$SRCPATH/editors/filemapper.h \
     $$SRCPATH/editors/abstracttextmapper.h \
+    $$SRCPATH/editors/linescanner.h \
     testfilemapper.h
 
 SOURCES += \
     $$SRCPATH/editors/filemapper.cpp \
     $$SRCPATH/editors/abstracttextmapper.cpp \
+    $$SRCPATH/editors/linescanner.cpp \
     $$SRCPATH/exception.cpp \
     $$SRCPATH/logger.cpp \
     testfilemapper.cpp
@@ -0,0 +1,186 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "testlinescanner.h"
+#include "benchmarksize.h"
+
+#include <QtGlobal>
+
+using gams::studio::LineScanner;
+
+static const int CMaxHugeMB = 1536;         // a QByteArray holds less than 2 GB
+
+Q_DECLARE_METATYPE(LineScanner::Level)
+
+void TestLineScanner::initTestCase()
+{
+    // line breaks of all kinds at all alignments
+    qsrand(42);
+    mSample.reserve(100000);
+    for (int i = 0; i < 100000; ++i) {
+        int r = qrand() % 40;
+        mSample.append(r == 0 ? '\n' : r == 1 ? '\r' : char('A' + r));
+    }
+}
+
+void TestLineScanner::cleanupTestCase()
+{
+    mHuge.clear();
+    mHuge.squeeze();
+    LineScanner::setLevel(LineScanner::AVX2);
+}
+
+void TestLineScanner::initHuge()
+{
+    if (!mHuge.isEmpty()) return;
+    const int hugeSize = int(qMin(benchmarkSize("STUDIO_LINESCANNER_MB", 16), qint64(CMaxHugeMB)) * 1024 * 1024);
+
+    // typical listing lines
+    const QByteArray line("---- 1234 VARIABLE x.L  level of shipment quantities in cases          12.3456\r\n");
+    mHuge.reserve(hugeSize);
+    while (mHuge.size() + line.size() <= hugeSize)
+        mHuge.append(line);
+}
+
+void TestLineScanner::addLevels()
+{
+    QTest::addColumn<LineScanner::Level>("level");
+    QTest::newRow("scalar") << LineScanner::Scalar;
+    QTest::newRow("SSE2") << LineScanner::SSE2;
+    QTest::newRow("AVX2") << LineScanner::AVX2;
+}
+
+void TestLineScanner::testLineStarts_data()
+{
+    addLevels();
+}
+
+void TestLineScanner::testLineStarts()
+{
+    QFETCH(LineScanner::Level, level);
+    LineScanner::setLevel(level);
+    for (int from = 0; from < 70; ++from) {
+        QVector<int> expected;
+        for (int i = from; i < mSample.size(); ++i)
+            if (mSample.at(i) == '\n') expected << i - from + 2;
+        QVector<int> lineStarts;
+        int count = LineScanner::lineStarts(mSample.constData() + from, mSample.size() - from, '\n', 2, lineStarts);
+        QCOMPARE(count, expected.size());
+        QCOMPARE(lineStarts, expected);
+    }
+}
+
+void TestLineScanner::testCount_data()
+{
+    addLevels();
+}
+
+void TestLineScanner::testCount()
+{
+    QFETCH(LineScanner::Level, level);
+    LineScanner::setLevel(level);
+    for (int from = 0; from < 70; ++from) {
+        int size = mSample.size() - from;
+        QCOMPARE(LineScanner::count(mSample.constData() + from, size, '\r'),
+                 mSample.mid(from).count('\r'));
+    }
+    QCOMPARE(LineScanner::count(mSample.constData(), 0, '\n'), 0);
+}
+
+void TestLineScanner::testNextLineBreak_data()
+{
+    addLevels();
+}
+
+void TestLineScanner::testNextLineBreak()
+{
+    QFETCH(LineScanner::Level, level);
+    LineScanner::setLevel(level);
+    int i = LineScanner::nextLineBreak(mSample.constData(), 0, mSample.size());
+    for (int expected = 0; expected < mSample.size(); ++expected) {
+        if (mSample.at(expected) != '\n' && mSample.at(expected) != '\r') continue;
+        QCOMPARE(i, expected);
+        i = LineScanner::nextLineBreak(mSample.constData(), i+1, mSample.size());
+    }
+    QCOMPARE(i, -1);
+    QCOMPARE(LineScanner::nextLineBreak("abc", 0, 3), -1);
+    QCOMPARE(LineScanner::nextLineBreak("abc\n", 4, 4), -1);
+}
+
+void TestLineScanner::benchmarkLineStarts_data()
+{
+    QTest::addColumn<int>("kernel");
+    QTest::newRow("former loop") << -1;
+    QTest::newRow("scalar") << int(LineScanner::Scalar);
+    QTest::newRow("SSE2") << int(LineScanner::SSE2);
+    QTest::newRow("AVX2") << int(LineScanner::AVX2);
+}
+
+void TestLineScanner::benchmarkLineStarts()
+{
+    QFETCH(int, kernel);
+    initHuge();
+    QVector<int> lineStarts;
+    QBENCHMARK {
+        lineStarts.clear();
+        if (kernel < 0) {
+            // the former index creation in FileMapper::getChunk()
+            int lines = mHuge.count('\r');
+            lineStarts.reserve(lines+1);
+            for (int i = 0; i < mHuge.size(); ++i) {
+                if (mHuge.at(i) == '\r') lineStarts << i + 2;
+            }
+        } else {
+            LineScanner::setLevel(LineScanner::Level(kernel));
+            LineScanner::lineStarts(mHuge.constData(), mHuge.size(), '\r', 2, lineStarts);
+        }
+    }
+    QCOMPARE(lineStarts.size(), mHuge.count('\n'));
+}
+
+void TestLineScanner::benchmarkLineBreaks_data()
+{
+    benchmarkLineStarts_data();
+}
+
+void TestLineScanner::benchmarkLineBreaks()
+{
+    QFETCH(int, kernel);
+    initHuge();
+    int breaks = 0;
+    QBENCHMARK {
+        breaks = 0;
+        if (kernel < 0) {
+            // the former byte-wise loop in MemoryMapper::addProcessData()
+            for (int i = 0; i < mHuge.length(); ++i) {
+                if (mHuge.at(i) == '\r' || mHuge.at(i) == '\n') ++breaks;
+            }
+        } else {
+            LineScanner::setLevel(LineScanner::Level(kernel));
+            int i = LineScanner::nextLineBreak(mHuge.constData(), 0, mHuge.size());
+            while (i >= 0) {
+                ++breaks;
+                i = LineScanner::nextLineBreak(mHuge.constData(), i+1, mHuge.size());
+            }
+        }
+    }
+    QCOMPARE(breaks, mHuge.count('\n') * 2);
+}
+
+QTEST_MAIN(TestLineScanner)
@@ -18,18 +18,38 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "testmemorymapper.h"
+#include "abstractprocess.h"
+#include "benchmarksize.h"
 #include "logger.h"
 
 #include <QtGlobal>
 #include <QStandardPaths>
 #include <QClipboard>
 #include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
 //#include <QThread>
 
+using gams::studio::AbstractProcess;
+using gams::studio::AbstractSingleProcess;
 using gams::studio::MemoryMapper;
+using gams::studio::LogParser;
 
 const QString testFileName("testtextmapper.tmp");
 
+class ReplayProcess : public AbstractSingleProcess
+{
+public:
+    ReplayProcess(bool batched) : AbstractSingleProcess(QString()) {
+        setBatchedOutput(batched);
+    }
+    void execute() override {
+        mProcess.start(application(), parameters());
+    }
+};
+
 void TestMemoryMapper::init()
 {
     mMapper = new MemoryMapper();
@@ -103,6 +123,126 @@ void TestMemoryMapper::testAddLine()
     DEB() << "LINES:\n" << mMapper->lines(3,7);
 }
 
+void TestMemoryMapper::testSpillChunks()
+{
+    mMapper->setMemoryBudget(0); // keeps only the minimal count of chunks in memory
+    for (int i = 0; i < 1000; ++i)
+        mMapper->addProcessData(QString("line %1\n").arg(i, 4, 10, QChar('0')).toLatin1());
+    QVERIFY(mMapper->lineCount() >= 1000);
+
+    mMapper->setVisibleTopLine(0);
+    QVERIFY(mMapper->lines(0, 3).contains("line 0000"));
+    mMapper->setVisibleTopLine(500);
+    QVERIFY(mMapper->lines(0, 3).contains("line 0500"));
+    mMapper->setVisibleTopLine(0);
+    QVERIFY(mMapper->lines(0, 3).contains("line 0001"));
+}
+
+void TestMemoryMapper::testPackChunks()
+{
+    mMapper->setMappingSizes(10, 64*1024, 1024);
+    mMapper->startRun();
+    for (int i = 0; i < 100000; ++i) {
+        mMapper->addProcessData(QString("%1 %2  %3  %4\n").arg(i, 8).arg(1.0e6 / (i+1), 14, 'e', 6)
+                                .arg(1.0e-3 * i, 14, 'e', 6).arg(i / 100.0, 8, 'f', 2).toLatin1());
+    }
+    qDebug() << QString("log size %1 KB, memory usage %2 KB").arg(mMapper->size() / 1024)
+                .arg(mMapper->memoryUsage() / 1024);
+    QVERIFY(mMapper->memoryUsage() * 2 < mMapper->size());
+
+    mMapper->setVisibleTopLine(0);
+    QVERIFY(mMapper->lines(0, 3).contains("1.000000e+06"));
+
+    // the line starts of a cold chunk are restored with its data
+    QVERIFY(mMapper->lineCount() >= 100000);
+    mMapper->setVisibleTopLine(50000);
+    QVERIFY(mMapper->lines(0, 4).contains("   50000 "));
+    mMapper->setVisibleTopLine(99990);
+    QVERIFY(mMapper->lines(0, 4).contains("   99990 "));
+}
+
+void TestMemoryMapper::testDecodedLines()
+{
+    mMapper->addProcessData("first line\nsecond ");
+    mMapper->setVisibleTopLine(0);
+    QCOMPARE(mMapper->lines(0, 2), QString("first line\nsecond \n"));
+
+    // the cached lines of the growing chunk need to be updated
+    mMapper->addProcessData("line\nthird line\n");
+    QCOMPARE(mMapper->lines(0, 3), QString("first line\nsecond line\nthird line\n"));
+    QCOMPARE(mMapper->lines(1, 1), QString("second line\n"));
+}
+
+void TestMemoryMapper::testReplayLog_data()
+{
+    QTest::addColumn<bool>("batched");
+    QTest::newRow("line by line") << false;
+    QTest::newRow("batched frames") << true;
+}
+
+void TestMemoryMapper::testReplayLog()
+{
+    // replays solver output through the process reader the way GamsProcess passes it to the log
+    QFETCH(bool, batched);
+    const qint64 logSize = benchmarkSize("STUDIO_REPLAY_LOG_MB", 100) * 1024 * 1024;
+    mMapper->setLogParser(new LogParser(QTextCodec::codecForName("utf-8")));
+    mMapper->setMappingSizes();
+    mMapper->startRun();
+
+    QByteArray block;
+    for (int i = 1; block.size() < 1024*1024; ++i) {
+        block.append(QString("Iteration %1  Objective %2  Infeasibility %3  Time %4\n")
+                     .arg(i, 8).arg(1.0e6 / i, 14, 'e', 6)
+                     .arg(1.0e-3 * i, 14, 'e', 6).arg(i / 100.0, 8, 'f', 2).toLatin1());
+        if (i % 1000 == 0) block.append("--- LOOPS t = 1\n--- some.gms(42) 12 Mb\n");
+    }
+    QFile logFile(QDir::temp().filePath("testreplaylog.tmp"));
+    QVERIFY(logFile.open(QFile::WriteOnly));
+    qint64 written = 0;
+    while (written < logSize)
+        written += logFile.write(block);
+    logFile.close();
+
+    ReplayProcess process(batched);
+#ifdef _WIN32
+    process.setApplication("cmd");
+    process.setParameters(QStringList() << "/c" << "type" << QDir::toNativeSeparators(logFile.fileName()));
+#else
+    process.setApplication("cat");
+    process.setParameters(QStringList() << logFile.fileName());
+#endif
+    // the time the GUI thread spends in the slot of one batch of output
+    QElapsedTimer call;
+    qint64 maxStall = 0;
+    qint64 bytes = 0;
+    int batches = 0;
+    connect(&process, &AbstractProcess::newStdChannelData, [&](const QByteArray &data) {
+        call.start();
+        mMapper->addProcessData(data);
+        maxStall = qMax(maxStall, call.nsecsElapsed());
+        bytes += data.size();
+        ++batches;
+    });
+    QEventLoop loop;
+    connect(&process, &AbstractProcess::finished, &loop, &QEventLoop::quit);
+    connect(&process, &AbstractProcess::stateChanged, [&loop](QProcess::ProcessState state) {
+        // also ends the loop if the process couldn't be started
+        if (state == QProcess::NotRunning) QTimer::singleShot(0, &loop, &QEventLoop::quit);
+    });
+    QElapsedTimer total;
+    total.start();
+    process.execute();
+    loop.exec();
+    double secs = total.nsecsElapsed() / 1.0e9;
+    logFile.remove();
+
+    qDebug() << QString("%1 MB in %2 batches, %3 s: %4 MB/s, max stall %5 ms")
+                .arg(bytes / 1024 / 1024).arg(batches).arg(secs, 0, 'f', 2).arg(bytes / 1024 / 1024 / secs, 0, 'f', 1)
+                .arg(maxStall / 1.0e6, 0, 'f', 3);
+    QCOMPARE(bytes, written);
+    QVERIFY(mMapper->lineCount() > 0);
+}
+
 //void TestMemoryMapper::testReadChunk0()
 //{
 //    int max = 1234567890;
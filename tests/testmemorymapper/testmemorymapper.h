@@ -34,6 +34,11 @@ private slots:
     void cleanup();
 
     void testAddLine();
+    void testSpillChunks();
+    void testPackChunks();
+    void testDecodedLines();
+    void testReplayLog_data();
+    void testReplayLog();
 
 //    void testReadChunk0();
 //    void testReadChunk1();
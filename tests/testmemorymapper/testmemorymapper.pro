@@ -22,18 +22,26 @@ TEMPLATE = app
 
 include(../tests.pri)
 
+QT += concurrent
+
 INCLUDEPATH += $$SRCPATH \
                $$SRCPATH/editors
 
 HEADERS += \
+    $$SRCPATH/abstractprocess.h \
+    $$SRCPATH/commonpaths.h \
     $$SRCPATH/editors/abstracttextmapper.h \
+    $$SRCPATH/editors/linescanner.h \
     $$SRCPATH/editors/logparser.h \
     $$SRCPATH/editors/memorymapper.h \
     $$SRCPATH/file/dynamicfile.h \
     testmemorymapper.h
 
 SOURCES += \
+    $$SRCPATH/abstractprocess.cpp \
+    $$SRCPATH/commonpaths.cpp \
     $$SRCPATH/editors/abstracttextmapper.cpp \
+    $$SRCPATH/editors/linescanner.cpp \
     $$SRCPATH/editors/logparser.cpp \
     $$SRCPATH/editors/memorymapper.cpp \
     $$SRCPATH/file/dynamicfile.cpp \
@@ -42,3 +42,5 @@ win32 {
 
 TESTSROOT = $$_PRO_FILE_PWD_/..
 SRCPATH = $$TESTSROOT/../src
+
+INCLUDEPATH += $$TESTSROOT
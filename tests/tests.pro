@@ -28,13 +28,19 @@ SUBDIRS +=                              \
            testcplexoption              \
            testdoclocation              \
            testeditors                  \
+           testfilemapper               \
            testgamslicenseinfo          \
            testgamsoption               \
            testgurobioption             \
+           testlinescanner              \
            testmemorymapper             \
            testminosoption              \
            testmiro                     \
            testoptionapi                \
+           testsearchworker             \
            testservicelocators          \
-           testsolverconfiginfo
-#           testfilemapper               \
+           testsolverconfiginfo         \
+           testsortengine               \
+           testsyntax                   \
+           testuelbitmap                \
+           testuelstore
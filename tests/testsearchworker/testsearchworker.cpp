@@ -0,0 +1,464 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "testsearchworker.h"
+#include "search/replaceworker.h"
+#include "search/searchresultlist.h"
+#include "search/trigramindex.h"
+#include "common.h"
+#include "benchmarksize.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextCodec>
+#include <QThread>
+#include <QThreadPool>
+#include <QtDebug>
+
+using gams::studio::search::ReplaceWorker;
+using gams::studio::search::Result;
+using gams::studio::search::SearchFile;
+using gams::studio::search::SearchResultList;
+using gams::studio::search::SearchWorker;
+using gams::studio::search::TrigramIndex;
+
+static const int CLineCount = 20000;
+static const qint64 CCorpusFileMB = 512;
+
+void TestSearchWorker::initTestCase()
+{
+    QVERIFY(mDir.isValid());
+    QTextCodec *utf8 = QTextCodec::codecForName("UTF-8");
+
+    // three files with mixed line endings, the matches of each file on different lines
+    for (int f = 0; f < 3; ++f) {
+        QByteArray data;
+        QString name = QString("file%1.gms").arg(f);
+        for (int line = 1; line <= CLineCount; ++line) {
+            if ((line + f) % 7 == 0) {
+                data.append("  x(i) = sum(j, foo(j)) + foo(i);");
+                mExpected << QString("%1:%2:%3").arg(name).arg(line).arg(16);
+                mExpected << QString("%1:%2:%3").arg(name).arg(line).arg(26);
+            } else {
+                data.append(QByteArray("* comment line ") + QByteArray::number(line));
+            }
+            data.append(line % 3 ? "\n" : "\r\n");
+        }
+        mFiles << SearchFile(writeFile(name, data), utf8);
+    }
+    // a file without any match and without trailing line break
+    mFiles << SearchFile(writeFile("empty.gms", QByteArray("no match here\n").repeated(100) + "last"), utf8);
+}
+
+void TestSearchWorker::cleanupTestCase()
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(QThread::idealThreadCount());
+}
+
+QString TestSearchWorker::writeFile(const QString &name, const QByteArray &data)
+{
+    QFile file(mDir.filePath(name));
+    if (!file.open(QIODevice::WriteOnly)) return QString();
+    file.write(data);
+    file.close();
+    return file.fileName();
+}
+
+QList<Result> TestSearchWorker::search(const QRegularExpression &regex, const QList<SearchFile> &files, qint64 rangeSize)
+{
+    SearchResultList list(regex);
+    QMutex mutex;
+    QThread thread;
+    SearchWorker *worker = new SearchWorker(mutex, regex, files, &list);
+    worker->setRangeSize(rangeSize);
+    worker->moveToThread(&thread);
+    connect(&thread, &QThread::started, worker, &SearchWorker::findInFiles);
+    thread.start();
+    thread.wait();
+    delete worker;
+    list.fetchQueuedResults();
+
+    QList<Result> res;
+    for (const SearchFile &file : files) {
+        for (int row : list.fileRows(file.location))
+            res << list.at(row);
+    }
+    return res;
+}
+
+void TestSearchWorker::testFindInFiles_data()
+{
+    QTest::addColumn<qint64>("rangeSize");
+    QTest::newRow("whole files") << qint64(1024*1024*1024);
+    QTest::newRow("ranges") << qint64(4096);
+    QTest::newRow("tiny ranges") << qint64(7);
+}
+
+void TestSearchWorker::testFindInFiles()
+{
+    QFETCH(qint64, rangeSize);
+    QList<Result> results = search(QRegularExpression("foo"), mFiles, rangeSize);
+    QStringList found;
+    for (const Result &r : results) {
+        found << QString("%1:%2:%3").arg(QFileInfo(r.filepath()).fileName()).arg(r.lineNr()).arg(r.colNr());
+        QCOMPARE(r.length(), 3);
+        QCOMPARE(r.context(), QString("x(i) = sum(j, foo(j)) + foo(i);"));
+    }
+    QCOMPARE(found, mExpected);
+}
+
+void TestSearchWorker::testUtf16()
+{
+    // UTF-16 files can't be split into byte ranges and are searched as a whole
+    QTextCodec *utf16 = QTextCodec::codecForName("UTF-16LE");
+    QString text;
+    for (int line = 1; line <= 1000; ++line)
+        text += (line % 10 ? QString("line %1\n").arg(line) : QString("bar %1\n").arg(line));
+    QList<SearchFile> files;
+    files << SearchFile(writeFile("utf16.gms", utf16->fromUnicode(text)), utf16);
+
+    QList<Result> results = search(QRegularExpression("bar"), files, 64);
+    QCOMPARE(results.size(), 100);
+    for (int i = 0; i < results.size(); ++i) {
+        QCOMPARE(results.at(i).lineNr(), (i+1) * 10);
+        QCOMPARE(results.at(i).colNr(), 0);
+    }
+}
+
+void TestSearchWorker::testLiteral_data()
+{
+    // the literal is searched on raw bytes, the equivalent regex is decoded and matched line by line
+    QTest::addColumn<QString>("literal");
+    QTest::addColumn<QString>("regex");
+    QTest::addColumn<bool>("caseSensitive");
+    QTest::newRow("plain") << "foo" << "fo[o]" << true;
+    QTest::newRow("case insensitive") << "FOO" << "FO[O]" << false;
+    QTest::newRow("whole word") << "\\bfoo\\b" << "\\bfo[o]\\b" << true;
+    QTest::newRow("whole word, insensitive") << "\\bFoO\\b" << "\\bfo[o]\\b" << false;
+    QTest::newRow("escaped") << "\\(i\\)" << "[(]i[)]" << true;
+    QTest::newRow("escaped whole word") << "\\b\\(i\\b" << "\\b[(]i\\b" << true;
+    QTest::newRow("non-ASCII") << QString::fromUtf8("größe") << QString::fromUtf8("größ[e]") << true;
+}
+
+void TestSearchWorker::testLiteral()
+{
+    QFETCH(QString, literal);
+    QFETCH(QString, regex);
+    QFETCH(bool, caseSensitive);
+
+    static QList<SearchFile> files;
+    if (files.isEmpty()) {
+        QByteArray data;
+        const QByteArray words[] = {"foo", "Foo", "FOO", "food", "xfoo_", "foo(i)", "a(i)", "(i", "_(i", "fo", "größe",
+                                    "GRÖSSE", "  ", "\t", "é"};
+        qsrand(7);
+        for (int line = 1; line <= 5000; ++line) {
+            int count = qrand() % 8;
+            for (int i = 0; i < count; ++i) {
+                if (i) data.append(qrand() % 2 ? " " : "");
+                data.append(words[qrand() % 15]);
+            }
+            data.append(line % 5 ? "\n" : "\r\n");
+        }
+        data.append("foo");
+        files << SearchFile(writeFile("literal.gms", data), QTextCodec::codecForName("UTF-8"));
+        files << SearchFile(writeFile("literal1.gms", QString::fromUtf8(data).toLatin1()), QTextCodec::codecForName("ISO-8859-1"));
+    }
+
+    QRegularExpression::PatternOptions options = caseSensitive ? QRegularExpression::NoPatternOption
+                                                               : QRegularExpression::CaseInsensitiveOption;
+    for (qint64 rangeSize : {qint64(1024*1024), qint64(1000)}) {
+        QList<Result> expected = search(QRegularExpression(regex, options), files, rangeSize);
+        QList<Result> results = search(QRegularExpression(literal, options), files, rangeSize);
+        QVERIFY(expected.size() > 0);
+        QCOMPARE(results.size(), expected.size());
+        for (int i = 0; i < results.size(); ++i) {
+            QCOMPARE(results.at(i).lineNr(), expected.at(i).lineNr());
+            QCOMPARE(results.at(i).colNr(), expected.at(i).colNr());
+            QCOMPARE(results.at(i).length(), expected.at(i).length());
+            QCOMPARE(results.at(i).context(), expected.at(i).context());
+        }
+    }
+}
+
+void TestSearchWorker::testResultList()
+{
+    SearchResultList list(QRegularExpression("a"));
+    list.addResult(1, 0, 1, "x.gms", "a a");
+    list.addResult(1, 2, 1, "x.gms", "a a");
+    list.addResult(5, 3, 1, "y.gms", QString::fromUtf8("größa"));
+    list.addResult(7, 0, 1, "x.gms", "a");
+    QCOMPARE(list.size(), 4);
+    QCOMPARE(list.rowCount(), 4);
+    QCOMPARE(list.fileRows("x.gms"), QVector<int>({0, 1, 3}));
+    QCOMPARE(list.fileRows("y.gms"), QVector<int>({2}));
+    QVERIFY(list.fileRows("z.gms").isEmpty());
+
+    Result r = list.at(1);
+    QCOMPARE(r.filepath(), QString("x.gms"));
+    QCOMPARE(r.lineNr(), 1);
+    QCOMPARE(r.colNr(), 2);
+    QCOMPARE(r.context(), QString("a a"));
+    QCOMPARE(list.at(2).context(), QString::fromUtf8("größa"));
+    QCOMPARE(list.at(3).context(), QString("a"));
+    QCOMPARE(list.data(list.index(2, 0)).toString(), QString("y.gms"));
+    QCOMPARE(list.data(list.index(2, 1)).toInt(), 5);
+
+    // queued results are appended to the model when they are fetched
+    list.queueResult(9, 0, 1, "y.gms", "a");
+    list.queueResult(9, 2, 1, "y.gms", "a a");
+    QCOMPARE(list.resultCount(), 6);
+    QCOMPARE(list.rowCount(), 4);
+    QCOMPARE(list.fetchQueuedResults(), 2);
+    QCOMPARE(list.fetchQueuedResults(), 0);
+    QCOMPARE(list.rowCount(), 6);
+    QCOMPARE(list.fileRows("y.gms"), QVector<int>({2, 4, 5}));
+    QCOMPARE(list.at(5).colNr(), 2);
+}
+
+void TestSearchWorker::testTrigrams_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<bool>("caseInsensitive");
+    QTest::addColumn<QString>("expected");    // the lowercase trigrams separated by blanks
+
+    QTest::newRow("literal")      << "Demand" << false << "and dem ema man";
+    QTest::newRow("escaped")      << "foo\\(j\\)" << false << "(j) foo o(j oo(";
+    QTest::newRow("alternatives") << "foo|bar" << false << "";
+    QTest::newRow("any char")     << "abc.def" << false << "abc def";
+    QTest::newRow("optional")     << "abcd?" << false << "abc";
+    QTest::newRow("group")        << "ab(cde)fg" << false << "";
+    QTest::newRow("word")         << "\\bsum\\b" << false << "sum";
+    QTest::newRow("class")        << "[a-z]+xyz\\d{2}" << false << "xyz";
+    QTest::newRow("caseless")     << "Model" << true << "del mod ode";
+    QTest::newRow("caseless k s") << "desk" << true << "";
+    QTest::newRow("non-ASCII")    << QString::fromUtf8("größe") << false << "";
+}
+
+void TestSearchWorker::testTrigrams()
+{
+    QFETCH(QString, pattern);
+    QFETCH(bool, caseInsensitive);
+    QFETCH(QString, expected);
+
+    QRegularExpression regex(pattern, caseInsensitive ? QRegularExpression::CaseInsensitiveOption
+                                                      : QRegularExpression::NoPatternOption);
+    QStringList res;
+    for (quint32 trigram : TrigramIndex::trigrams(regex))
+        res << QString(QChar(trigram >> 16)) + QChar((trigram >> 8) & 0xff) + QChar(trigram & 0xff);
+    QCOMPARE(res.join(' '), expected);
+}
+
+void TestSearchWorker::testTrigramIndex()
+{
+    QString fileA = writeFile("indexA.gms", "Parameter demand(j)\n/ new-york 325 /;\n");
+    QString fileB = writeFile("indexB.gms", "Set i / seattle, san-diego /;\n");
+    QString indexFile = mDir.filePath("index/searchindex.gti");
+    QVector<quint32> trigrams = TrigramIndex::trigrams(QRegularExpression("DEMAND"));
+    {
+        TrigramIndex index(indexFile);
+        index.update(fileA);
+        index.update(fileB);
+        index.waitForIndexing();
+        QCOMPARE(index.indexedFiles(), 2);
+        QVERIFY(index.mayContain(fileA, trigrams));
+        QVERIFY(!index.mayContain(fileB, trigrams));
+        QVERIFY(index.mayContain(mDir.filePath("unknown.gms"), trigrams));
+        QVERIFY(index.mayContain(fileB, QVector<quint32>()));
+    }
+    QVERIFY(QFile::exists(indexFile));
+
+    // the stored index is loaded again, its entries are used after the background thread validated them
+    TrigramIndex index(indexFile);
+    index.waitForIndexing();
+    QCOMPARE(index.indexedFiles(), 2);
+    QVERIFY(index.mayContain(fileB, trigrams));
+    index.waitForIndexing();
+    QVERIFY(!index.mayContain(fileB, trigrams));
+
+    // changed files are candidates until they are indexed again, the file watcher calls update
+    writeFile("indexB.gms", "Set i / seattle, san-diego /;\nParameter demand(i);\n");
+    index.update(fileB);
+    QVERIFY(index.mayContain(fileB, trigrams));
+    index.waitForIndexing();
+    QVERIFY(index.mayContain(fileB, trigrams));
+
+    // a change of the content that keeps the size and the modification time is detected by the content hash
+    QDateTime modified = QFileInfo(fileB).lastModified();
+    writeFile("indexB.gms", "Set i / seattle, san-diego /;\nParameter supply(i);\n");
+    QFile file(fileB);
+    QVERIFY(file.open(QFile::ReadWrite | QFile::ExistingOnly));
+    QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    file.close();
+    index.update(fileB);
+    index.waitForIndexing();
+    QVERIFY(!index.mayContain(fileB, trigrams));
+    index.remove(fileA);
+    QCOMPARE(index.indexedFiles(), 1);
+}
+
+static QByteArray utf16le(const QString &text)
+{
+    QByteArray res;
+    for (const QChar &c : text)
+        res.append(char(c.unicode() & 0xff)).append(char(c.unicode() >> 8));
+    return res;
+}
+
+void TestSearchWorker::testReplaceInFile_data()
+{
+    QTest::addColumn<int>("mib");
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QString>("replaceTerm");
+    QTest::addColumn<QByteArray>("expected");
+    QTest::addColumn<int>("hits");
+
+    QTest::newRow("line endings") << 106 << QByteArray("foo a\r\nbar foo\rfoo\n\nfoo") << "foo" << "baz"
+                                  << QByteArray("baz a\r\nbar baz\rbaz\n\nbaz") << 4;
+    QTest::newRow("UTF-8 BOM")    << 106 << QByteArray("\xEF\xBB\xBFx = foo;\r\n") << "foo" << QString::fromUtf8("größe")
+                                  << QByteArray("\xEF\xBB\xBFx = gr\xC3\xB6\xC3\x9F" "e;\r\n") << 1;
+    QTest::newRow("Latin-1")      << 4 << QByteArray("gr\xF6\xDF" "e foo\n") << "foo" << "bar"
+                                  << QByteArray("gr\xF6\xDF" "e bar\n") << 1;
+    QTest::newRow("captures")     << 106 << QByteArray("a(1) a(2)\n") << "a\\((\\d)\\)" << "b[\\1]"
+                                  << QByteArray("b[1] b[2]\n") << 2;
+    QTest::newRow("no match")     << 106 << QByteArray("nothing\n") << "foo" << "bar"
+                                  << QByteArray("nothing\n") << 0;
+    QTest::newRow("UTF-16LE BOM") << 1015 << QByteArray("\xFF\xFE") + utf16le("foo\r\nfoo") << "foo" << "ab"
+                                  << QByteArray("\xFF\xFE") + utf16le("ab\r\nab") << 2;
+}
+
+void TestSearchWorker::testReplaceInFile()
+{
+    QFETCH(int, mib);
+    QFETCH(QByteArray, data);
+    QFETCH(QString, pattern);
+    QFETCH(QString, replaceTerm);
+    QFETCH(QByteArray, expected);
+    QFETCH(int, hits);
+
+    QString location = writeFile("replace.gms", data);
+    SearchFile file(location, QTextCodec::codecForMib(mib));
+    QCOMPARE(ReplaceWorker::replaceInFile(file, QRegularExpression(pattern), replaceTerm), hits);
+    QFile result(location);
+    QVERIFY(result.open(QFile::ReadOnly));
+    QCOMPARE(result.readAll(), expected);
+}
+
+void TestSearchWorker::testReplaceInFiles()
+{
+    QList<SearchFile> files;
+    QTextCodec *utf8 = QTextCodec::codecForName("UTF-8");
+    for (int i = 0; i < 20; ++i) {
+        QByteArray data = QByteArray("x(i) = foo(i);\n").repeated(i) + "end\n";
+        files << SearchFile(writeFile(QString("replace%1.gms").arg(i), data), utf8);
+    }
+    files << SearchFile(mDir.filePath("missing.gms"), utf8);
+
+    QThread thread;
+    ReplaceWorker *worker = new ReplaceWorker(QRegularExpression("foo"), "bar", files);
+    QVector<int> hits;
+    worker->moveToThread(&thread);
+    connect(&thread, &QThread::started, worker, &ReplaceWorker::replaceInFiles);
+    connect(worker, &ReplaceWorker::finished, worker, [&hits](const QVector<int> &fileHits) { hits = fileHits; },
+            Qt::DirectConnection);
+    thread.start();
+    thread.wait();
+    delete worker;
+
+    QCOMPARE(hits.size(), files.size());
+    for (int i = 0; i < 20; ++i) {
+        QCOMPARE(hits.at(i), i);
+        QFile file(files.at(i).location);
+        QVERIFY(file.open(QFile::ReadOnly));
+        QCOMPARE(file.readAll(), QByteArray("x(i) = bar(i);\n").repeated(i) + "end\n");
+    }
+    QCOMPARE(hits.last(), -1);
+}
+
+void TestSearchWorker::benchmarkFindInFiles_data()
+{
+    QTest::addColumn<int>("threads");
+    QTest::addColumn<QString>("pattern");
+    QTest::newRow("regex, single worker") << 1 << "supply\\(\\w+\\)";
+    QTest::newRow("regex, all cores") << QThread::idealThreadCount() << "supply\\(\\w+\\)";
+    QTest::newRow("literal, single worker") << 1 << "supply\\(seattle\\)";
+    QTest::newRow("literal, all cores") << QThread::idealThreadCount() << "supply\\(seattle\\)";
+}
+
+void TestSearchWorker::benchmarkFindInFiles()
+{
+    QFETCH(int, threads);
+    QFETCH(QString, pattern);
+    const qint64 corpusMB = benchmarkSize("STUDIO_SEARCH_CORPUS_MB", 256);
+
+    // a synthetic corpus of listing-like lines, split into files of at most CCorpusFileMB
+    static QList<SearchFile> corpus;
+    if (corpus.isEmpty()) {
+        const QByteArray line("---- 1234 VARIABLE x.L  level of shipment quantities in cases          12.3456\r\n");
+        const QByteArray hit("---- 1235 EQUATION supply(seattle)  observe supply limit at plant i   350.0000\r\n");
+        QByteArray block;
+        for (int i = 0; i < 10000; ++i)
+            block.append(i ? line : hit);
+        for (int f = 0; corpusMB > 0; ++f) {
+            qint64 fileMB = qMin(corpusMB, CCorpusFileMB);
+            QFile file(mDir.filePath(QString("corpus%1.lst").arg(f)));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            for (qint64 written = 0; written < fileMB*1024*1024; written += block.size())
+                file.write(block);
+            file.close();
+            corpus << SearchFile(file.fileName(), QTextCodec::codecForName("UTF-8"));
+            corpusMB -= fileMB;
+        }
+    }
+
+    QThreadPool::globalInstance()->setMaxThreadCount(threads);
+    qint64 bytes = 0;
+    for (const SearchFile &file : corpus)
+        bytes += QFileInfo(file.location).size();
+    QElapsedTimer timer;
+    timer.start();
+    QList<Result> results;
+    QBENCHMARK_ONCE {
+        results = search(QRegularExpression(pattern), corpus, 64*1024*1024);
+    }
+    qint64 ms = qMax(qint64(1), timer.elapsed());
+    qDebug() << pattern << threads << "worker(s):" << bytes / 1024 / 1024 << "MB in" << ms << "ms,"
+             << (bytes / 1024 / 1024 * 1000 / ms) << "MB/s," << results.size() << "results";
+    QVERIFY(results.size() > 0);
+}
+
+void TestSearchWorker::benchmarkResultAccess()
+{
+    // the data of the visible rows is requested with each repaint of the results view
+    SearchResultList list(QRegularExpression("x"));
+    for (int i = 0; i < MAX_SEARCH_RESULTS; ++i)
+        list.addResult(i % 5000 + 1, 4, 1, QString("file%1.gms").arg(i / 5000), "x(i) = y(i) + 1;");
+    int sum = 0;
+    QBENCHMARK {
+        for (int row = 0; row < list.size(); row += 97)
+            sum += list.data(list.index(row, 2)).toString().size();
+    }
+    QVERIFY(sum > 0);
+    QCOMPARE(list.fileRows("file7.gms").size(), 5000);
+}
+
+QTEST_MAIN(TestSearchWorker)
@@ -0,0 +1,63 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TESTSEARCHWORKER_H
+#define TESTSEARCHWORKER_H
+
+#include "search/searchresultlist.h"
+#include "search/searchworker.h"
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+class TestSearchWorker : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testFindInFiles_data();
+    void testFindInFiles();
+    void testUtf16();
+    void testLiteral_data();
+    void testLiteral();
+    void testResultList();
+    void testTrigrams_data();
+    void testTrigrams();
+    void testTrigramIndex();
+    void testReplaceInFile_data();
+    void testReplaceInFile();
+    void testReplaceInFiles();
+
+    void benchmarkFindInFiles_data();
+    void benchmarkFindInFiles();
+    void benchmarkResultAccess();
+
+private:
+    QString writeFile(const QString &name, const QByteArray &data);
+    QList<gams::studio::search::Result> search(const QRegularExpression &regex,
+                                               const QList<gams::studio::search::SearchFile> &files,
+                                               qint64 rangeSize);
+    QTemporaryDir mDir;
+    QList<gams::studio::search::SearchFile> mFiles;
+    QStringList mExpected;      // "file:line:col" of all expected matches
+};
+
+#endif // TESTSEARCHWORKER_H
@@ -0,0 +1,136 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "testsortengine.h"
+#include "sortengine.h"
+#include "benchmarksize.h"
+
+#include <QElapsedTimer>
+#include <limits>
+
+using gams::studio::SortEngine;
+
+void TestSortEngine::testKeys()
+{
+    QVERIFY(SortEngine::intKey(-5) < SortEngine::intKey(-1));
+    QVERIFY(SortEngine::intKey(-1) < SortEngine::intKey(0));
+    QVERIFY(SortEngine::intKey(0) < SortEngine::intKey(7));
+
+    const double inf = std::numeric_limits<double>::infinity();
+    QList<double> values {-inf, -1e300, -2.5, -1e-300, 0.0, 1e-300, 4.94066E-324 * 2, 3.0, 1e300, inf};
+    std::sort(values.begin(), values.end());
+    for (int i = 1; i < values.size(); ++i)
+        QVERIFY(SortEngine::doubleKey(values.at(i-1)) < SortEngine::doubleKey(values.at(i)));
+    QCOMPARE(SortEngine::doubleKey(-0.0), SortEngine::doubleKey(0.0));
+}
+
+void TestSortEngine::testSort_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("descending");
+    QTest::newRow("small ascending") << 1000 << false;
+    QTest::newRow("small descending") << 1000 << true;
+    QTest::newRow("large ascending") << 300000 << false;
+    QTest::newRow("large descending") << 300000 << true;
+}
+
+void TestSortEngine::testSort()
+{
+    QFETCH(int, count);
+    QFETCH(bool, descending);
+    qsrand(42);
+    std::vector<int> group(size_t(count));
+    std::vector<double> values(size_t(count));
+    std::vector<int> indices(size_t(count));
+    for (int i = 0; i < count; ++i) {
+        group[size_t(i)] = qrand() % 10 - 5;
+        values[size_t(i)] = double(qrand() % 1000 - 500) / 7.0;
+        indices[size_t(i)] = count - 1 - i;
+    }
+    SortEngine engine;
+    engine.addKey([&group](int i) { return SortEngine::intKey(group[size_t(i)]); },
+                  descending ? Qt::DescendingOrder : Qt::AscendingOrder);
+    engine.addKey([&values](int i) { return SortEngine::doubleKey(values[size_t(i)]); });
+    std::vector<int> sorted = indices;
+    QVERIFY(engine.sort(sorted));
+
+    std::vector<int> expected = indices;
+    std::stable_sort(expected.begin(), expected.end(), [&group, &values, descending](int a, int b) {
+        if (group[size_t(a)] != group[size_t(b)])
+            return descending ? group[size_t(a)] > group[size_t(b)] : group[size_t(a)] < group[size_t(b)];
+        return values[size_t(a)] < values[size_t(b)];
+    });
+    QVERIFY(sorted == expected);
+}
+
+void TestSortEngine::testCancel()
+{
+    QAtomicInt cancel(1);
+    SortEngine engine;
+    engine.setCancelFlag(&cancel);
+    engine.addKey([](int i) { return quint64(100 - i); });
+    std::vector<int> indices {1, 2, 3};
+    QVERIFY(!engine.sort(indices));
+    QVERIFY(indices == std::vector<int>({1, 2, 3}));
+
+    cancel.store(0);
+    QVERIFY(engine.sort(indices));
+    QVERIFY(indices == std::vector<int>({3, 2, 1}));
+}
+
+void TestSortEngine::testStringRanks()
+{
+    QStringList strings {"beta", "Alpha", "beta", "alpha", "Gamma"};
+    std::vector<int> ranks = SortEngine::stringRanks(strings, false);
+    QVERIFY(ranks == std::vector<int>({3, 0, 3, 2, 1}));
+
+    ranks = SortEngine::stringRanks(strings, true);
+    QCOMPARE(ranks[0], ranks[2]);
+    for (int a = 0; a < strings.size(); ++a) {
+        for (int b = 0; b < strings.size(); ++b) {
+            int cmp = QString::localeAwareCompare(strings.at(a), strings.at(b));
+            if (cmp < 0) QVERIFY(ranks[size_t(a)] < ranks[size_t(b)]);
+            if (cmp > 0) QVERIFY(ranks[size_t(a)] > ranks[size_t(b)]);
+        }
+    }
+}
+
+void TestSortEngine::benchmarkDoubles()
+{
+    const int count = int(benchmarkSize("STUDIO_SORT_COUNT", 1000000));
+    qsrand(7);
+    std::vector<double> values(size_t(count));
+    std::vector<int> indices(size_t(count));
+    for (int i = 0; i < count; ++i) {
+        values[size_t(i)] = (double(qrand()) - RAND_MAX / 2) * double(qrand());
+        indices[size_t(i)] = i;
+    }
+    SortEngine engine;
+    engine.addKey([&values](int i) { return SortEngine::doubleKey(values[size_t(i)]); });
+    QElapsedTimer timer;
+    QBENCHMARK_ONCE {
+        timer.start();
+        engine.sort(indices);
+    }
+    qDebug() << count << "doubles sorted in" << timer.elapsed() << "ms";
+    for (int i = 1; i < count; ++i)
+        QVERIFY(values[size_t(indices[size_t(i-1)])] <= values[size_t(indices[size_t(i)])]);
+}
+
+QTEST_MAIN(TestSortEngine)
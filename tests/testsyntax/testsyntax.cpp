@@ -0,0 +1,133 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "testsyntax.h"
+#include "syntaxdeclaration.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QTextStream>
+
+using namespace gams::studio::syntax;
+
+Q_DECLARE_METATYPE(QList<QPair<QString, QString>>)
+
+void TestSyntax::testDictList_data()
+{
+    QTest::addColumn<QList<QPair<QString, QString>>>("keywords");
+    QTest::addColumn<QString>("line");
+    QTest::addColumn<int>("index");
+    QTest::addColumn<bool>("openEnd");
+    QTest::addColumn<int>("end");
+    QTest::addColumn<int>("key");   // the index in the case-insensitive sorted keywords
+
+    QList<QPair<QString, QString>> sets {{"Sets", ""}, {"Set", ""}};
+    QTest::newRow("exact") << sets << "Set i;" << 0 << false << 3 << 0;
+    QTest::newRow("longer") << sets << "sets i;" << 0 << false << 4 << 1;
+    QTest::newRow("case") << sets << "SeTs" << 0 << false << 4 << 1;
+    QTest::newRow("index") << sets << "  set" << 2 << false << 5 << 0;
+    QTest::newRow("prefix") << sets << "se" << 0 << false << -1 << -1;
+    QTest::newRow("identifier") << sets << "settings" << 0 << false << -1 << -1;
+    QTest::newRow("empty") << sets << "" << 0 << false << -1 << -1;
+    QTest::newRow("at end") << sets << "set" << 3 << false << -1 << -1;
+
+    QList<QPair<QString, QString>> models {{"mip", ""}, {"minlp", ""}, {"lp", ""}, {"nlp", ""}, {"rmip", ""}};
+    QTest::newRow("model") << models << "using MINLP min z;" << 6 << false << 11 << 1;
+    QTest::newRow("partial") << models << "minl" << 0 << false << -1 << -1;
+    QTest::newRow("open end") << models << "mipopt" << 0 << true << 3 << 2;
+    QTest::newRow("open exact") << models << "rmip;" << 0 << true << 4 << 4;
+    QTest::newRow("closed end") << models << "mipopt" << 0 << false << -1 << -1;
+
+    QList<QPair<QString, QString>> prefixes {{"ab", ""}, {"abc", ""}, {"x.l", ""}};
+    QTest::newRow("shortest") << prefixes << "abcd" << 0 << true << 2 << 0;
+    QTest::newRow("longest") << prefixes << "abc" << 0 << false << 3 << 1;
+    QTest::newRow("dot") << prefixes << "X.L = 1" << 0 << false << 3 << 2;
+    QTest::newRow("dot prefix") << prefixes << "x.lo" << 0 << false << -1 << -1;
+}
+
+void TestSyntax::testDictList()
+{
+    QFETCH(QList<QPair<QString, QString>>, keywords);
+    QFETCH(QString, line);
+    QFETCH(int, index);
+    QFETCH(bool, openEnd);
+    QFETCH(int, end);
+    QFETCH(int, key);
+
+    DictList dict(keywords);
+    QCOMPARE(dict.count(), keywords.size());
+    int iKey;
+    QCOMPARE(dict.match(line, index, iKey, openEnd), end);
+    if (end >= 0) QCOMPARE(iKey, key);
+}
+
+void TestSyntax::benchmarkKeywords()
+{
+    // the keyword kinds are tried at each identifier of the GAMS model library
+    QString sysDir = QFileInfo(QStandardPaths::findExecutable("gams")).absolutePath();
+    QDir libDir(QDir(sysDir).filePath("gamslib_ml"));
+    QStringList files = libDir.entryList(QStringList() << "*.gms", QDir::Files);
+    if (sysDir.isEmpty() || files.isEmpty())
+        QSKIP("GAMS model library not found");
+
+    QStringList lines;
+    qint64 bytes = 0;
+    for (const QString &fileName : files) {
+        QFile file(libDir.filePath(fileName));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) continue;
+        QTextStream in(&file);
+        while (!in.atEnd()) {
+            lines << in.readLine();
+            bytes += lines.last().length() + 1;
+        }
+    }
+    QList<SyntaxAbstract*> kinds;
+    kinds << new SyntaxDeclaration() << new SyntaxPreDeclaration(SyntaxKind::DeclarationSetType)
+          << new SyntaxPreDeclaration(SyntaxKind::DeclarationVariableType) << new SyntaxDeclarationTable()
+          << new SyntaxReserved(SyntaxKind::Reserved) << new SyntaxReserved(SyntaxKind::Solve)
+          << new SyntaxReserved(SyntaxKind::Option) << new SyntaxEmbedded(SyntaxKind::Embedded)
+          << new SyntaxEmbedded(SyntaxKind::EmbeddedEnd) << new SyntaxSubsetKey(SyntaxKind::SolveKey)
+          << new SyntaxSubsetKey(SyntaxKind::OptionKey);
+
+    int matches = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK_ONCE {
+        for (const QString &line : lines) {
+            bool inWord = false;
+            for (int i = 0; i < line.length(); ++i) {
+                bool wordChar = line.at(i).isLetterOrNumber() || line.at(i) == '_';
+                if (wordChar && !inWord) {
+                    for (SyntaxAbstract *syntax : kinds) {
+                        if (syntax->find(SyntaxKind::Standard, line, i).isValid()) ++matches;
+                    }
+                }
+                inWord = wordChar;
+            }
+        }
+    }
+    qint64 ms = qMax(qint64(1), timer.elapsed());
+    qDebug() << files.size() << "models:" << bytes / 1024 << "KB in" << ms << "ms,"
+             << (double(bytes) / 1024 / 1024 * 1000 / ms) << "MB/s," << matches << "keywords";
+    qDeleteAll(kinds);
+    QVERIFY(matches > 0);
+}
+
+QTEST_MAIN(TestSyntax)
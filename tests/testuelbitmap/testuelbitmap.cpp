@@ -0,0 +1,142 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "testuelbitmap.h"
+#include "gdxviewer/uelbitmap.h"
+#include "editors/linescanner.h"
+#include "benchmarksize.h"
+
+#include <QElapsedTimer>
+
+using gams::studio::LineScanner;
+using gams::studio::gdxviewer::UelBitmap;
+
+Q_DECLARE_METATYPE(LineScanner::Level)
+
+void TestUelBitmap::cleanupTestCase()
+{
+    LineScanner::setLevel(LineScanner::AVX2);
+}
+
+void TestUelBitmap::addLevels()
+{
+    QTest::addColumn<LineScanner::Level>("level");
+    QTest::newRow("scalar") << LineScanner::Scalar;
+    QTest::newRow("AVX2") << LineScanner::AVX2;
+}
+
+void TestUelBitmap::testContains()
+{
+    UelBitmap empty(5, 4, true);
+    QCOMPARE(empty.count(), 0);
+    QVERIFY(empty.isEmpty());
+    QVERIFY(!empty.contains(5));
+
+    UelBitmap bitmap(10, 74);
+    QVERIFY(bitmap.isEmpty());
+    bitmap.set(10);
+    bitmap.set(42);
+    bitmap.set(74);
+    QCOMPARE(bitmap.count(), 3);
+    QVERIFY(bitmap.contains(10));
+    QVERIFY(bitmap.contains(42));
+    QVERIFY(bitmap.contains(74));
+    QVERIFY(!bitmap.contains(11));
+    QVERIFY(!bitmap.contains(9));     // outside of the range
+    QVERIFY(!bitmap.contains(75));
+    bitmap.set(42, false);
+    QVERIFY(!bitmap.contains(42));
+
+    bitmap.fill(true);
+    QCOMPARE(bitmap.count(), 65);
+    QVERIFY(!bitmap.contains(75));
+}
+
+void TestUelBitmap::testXor()
+{
+    UelBitmap all(1, 100, true);
+    UelBitmap some(1, 100);
+    for (uint uel = 1; uel <= 100; uel += 3)
+        some.set(uel);
+    UelBitmap toggled = all ^ some;
+    QCOMPARE(toggled.count(), all.count() - some.count());
+    QVERIFY(!toggled.contains(1));
+    QVERIFY(toggled.contains(2));
+    QVERIFY((some ^ some).isEmpty());
+    QVERIFY((toggled ^ some) == all);
+}
+
+void TestUelBitmap::testSelect_data()
+{
+    addLevels();
+}
+
+void TestUelBitmap::testSelect()
+{
+    QFETCH(LineScanner::Level, level);
+    LineScanner::setLevel(level);
+    qsrand(42);
+    UelBitmap bitmap(20, 300);
+    for (uint uel = 20; uel <= 300; ++uel) {
+        if (qrand() % 3 == 0) bitmap.set(uel);
+    }
+    // keys below, within and above the range of the bitmap
+    std::vector<uint> keys(10007);
+    for (uint &key : keys)
+        key = uint(qrand() % 350);
+
+    std::vector<int> hits;
+    int count = bitmap.select(keys.data(), int(keys.size()), 5, hits);
+    std::vector<int> expected;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (bitmap.contains(keys[i])) expected.push_back(int(i) + 5);
+    }
+    QCOMPARE(count, int(expected.size()));
+    QVERIFY(hits == expected);
+}
+
+void TestUelBitmap::benchmarkSelect_data()
+{
+    addLevels();
+}
+
+void TestUelBitmap::benchmarkSelect()
+{
+    QFETCH(LineScanner::Level, level);
+    LineScanner::setLevel(level);
+    // toggling a single label of a column with many records
+    const int count = int(benchmarkSize("STUDIO_SELECT_COUNT", 2000000));
+    qsrand(7);
+    std::vector<uint> keys(size_t(count));
+    for (uint &key : keys)
+        key = uint(qrand() % 5000);
+    UelBitmap toggled(0, 4999);
+    toggled.set(17);
+
+    QElapsedTimer timer;
+    std::vector<int> hits;
+    QBENCHMARK_ONCE {
+        timer.start();
+        toggled.select(keys.data(), count, 0, hits);
+    }
+    qDebug() << count << "keys looked up in" << timer.elapsed() << "ms," << hits.size() << "hits";
+    QVERIFY(hits.size() > 0);
+}
+
+QTEST_MAIN(TestUelBitmap)
@@ -0,0 +1,111 @@
+/*
+ * This file is part of the GAMS Studio project.
+ *
+ * Copyright (c) 2017-2019 GAMS Software GmbH <support@gams.com>
+ * Copyright (c) 2017-2019 GAMS Development Corp. <support@gams.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "testuelstore.h"
+#include "gdxviewer/uelstore.h"
+#include "benchmarksize.h"
+
+#include <QElapsedTimer>
+#include <QTextCodec>
+
+using gams::studio::gdxviewer::UelStore;
+
+static QByteArray randomLabel(int maxLen)
+{
+    static const char chars[] = "abcXYZ_019";
+    int len = 1 + qrand() % maxLen;
+    QByteArray res(len, ' ');
+    for (int i = 0; i < len; ++i)
+        res[i] = chars[qrand() % (sizeof(chars)-1)];
+    return res;
+}
+
+void TestUelStore::testLabels()
+{
+    UelStore store(QTextCodec::codecForName("ISO-8859-1"));
+    QCOMPARE(store.count(), 0);
+    store.append("INVALID");
+    store.append("seattle");
+    store.append("");
+    store.append("K\xf6ln");
+    QCOMPARE(store.count(), 4);
+    QCOMPARE(store.label(0), QString("INVALID"));
+    QCOMPARE(store.label(1), QString("seattle"));
+    QCOMPARE(store.label(2), QString());
+    QCOMPARE(store.label(3), QString::fromUtf8("K\xc3\xb6ln"));
+}
+
+void TestUelStore::testSortRanks_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("maxLen");
+    QTest::newRow("few") << 100 << 12;
+    QTest::newRow("short labels") << 300000 << 3;
+    QTest::newRow("long labels") << 300000 << 20;
+}
+
+void TestUelStore::testSortRanks()
+{
+    QFETCH(int, count);
+    QFETCH(int, maxLen);
+    qsrand(42);
+    QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+    UelStore store(codec);
+    store.append("\xc3\xa4pfel");   // äpfel
+    store.append("\xc3\x84PFEL2");  // ÄPFEL2
+    store.append("Zebra");
+    store.append("apfel");
+    for (int i = store.count(); i < count; ++i)
+        store.append(randomLabel(maxLen).constData());
+
+    std::vector<int> ranks = store.sortRanks();
+    QCOMPARE(int(ranks.size()), count);
+    std::vector<int> order(size_t(count), -1);
+    for (int uel = 0; uel < count; ++uel) {
+        QVERIFY(ranks[size_t(uel)] >= 0 && ranks[size_t(uel)] < count);
+        QCOMPARE(order[size_t(ranks[size_t(uel)])], -1);
+        order[size_t(ranks[size_t(uel)])] = uel;
+    }
+    for (int i = 1; i < count; ++i) {
+        QString prev = store.label(order[size_t(i-1)]);
+        QString cur = store.label(order[size_t(i)]);
+        if (prev.compare(cur, Qt::CaseInsensitive) > 0)
+            QFAIL(qPrintable(QString("'%1' sorted before '%2'").arg(prev, cur)));
+    }
+}
+
+void TestUelStore::benchmarkSortRanks()
+{
+    qsrand(7);
+    const int count = int(benchmarkSize("STUDIO_UEL_COUNT", 500000));
+    UelStore store;
+    store.reserve(count);
+    for (int i = 0; i < count; ++i)
+        store.append(randomLabel(16).constData());
+    QElapsedTimer timer;
+    std::vector<int> ranks;
+    QBENCHMARK_ONCE {
+        timer.start();
+        ranks = store.sortRanks();
+    }
+    qDebug() << count << "labels sorted in" << timer.elapsed() << "ms";
+    QCOMPARE(int(ranks.size()), count);
+}
+
+QTEST_MAIN(TestUelStore)